@@ -1,8 +1,16 @@
 #include "bootrom.h"
 #include "bus.h"
 #include "cartridge.h"
+#include "codecache.h"
+#include "doctor.h"
+#include "interrupts.h"
+#include "joypad.h"
+#include "ppu.h"
+#include "serial.h"
+#include "tilecache.h"
 #include "timer.h"
 #include "constants.h"
+#include "instrument.h"
 #include "memory.h"
 #include "utils.h"
 #include <assert.h>
@@ -13,17 +21,29 @@ namespace Bus
 	void StoreU8_PPU(u16 address, u8 val);
 }
 
+// Stores to RAM also tell any code cached from that page, see CodeCache
+inline void StoreRAM(u16 address, u8 val)
+{
+	Memory::StoreU8(address, val);
+	CodeCache::NotifyStore(address);
+}
+
 inline u8 HandleIORead(u16 address)
 {
 	SpecialRegister special_register = SpecialRegister(address);
 	switch (special_register)
 	{
+	case SpecialRegister::JOYPAD: return Joypad::R_P1();
+	case SpecialRegister::SERIAL_DATA: return Serial::R_SB();
+	case SpecialRegister::SERIAL_CONTROL: return Serial::R_SC();
+
 	case SpecialRegister::DIV:	return Timer::R_DIV();
 	case SpecialRegister::TIMA: return Timer::R_TIMA();
 	case SpecialRegister::TMA:	return Timer::R_TMA();
 	case SpecialRegister::TAC:	return Timer::R_TAC();
 
-	case SpecialRegister::INTERRUPT_FLAG:
+	case SpecialRegister::INTERRUPT_FLAG: return Interrupts::R_IF();
+
 	case SpecialRegister::SOUND_NR11:
 	case SpecialRegister::SOUND_NR12:
 	case SpecialRegister::SOUND_NR13:
@@ -35,16 +55,20 @@ inline u8 HandleIORead(u16 address)
 	case SpecialRegister::VIDEO_LCD_STATUS:
 	case SpecialRegister::VIDEO_SCROLLY:
 	case SpecialRegister::VIDEO_SCROLLX:
-	case SpecialRegister::VIDEO_CURRENT_SCANLINE:
 	case SpecialRegister::VIDEO_BG_PALETTE:
 	case SpecialRegister::VIDEO_SPRITE0_PALETTE:
 	case SpecialRegister::VIDEO_SPRITE1_PALETTE:
+	case SpecialRegister::VIDEO_OAM_DMA:
+	case SpecialRegister::VIDEO_WINDOW_Y:
+	case SpecialRegister::VIDEO_WINDOW_X:
 	{
 		return Memory::LoadU8(address);
 	}
+	case SpecialRegister::VIDEO_CURRENT_SCANLINE:
+		return Doctor::stubLY ? 0x90 : Memory::LoadU8(address);
 	}
-	assert(false);
-	return 0;
+	// Unmapped, like FF4D (the CGB speed switch) that cpu_instrs reads. The bus floats high.
+	return 0xFF;
 }
 
 inline void HandleIOWrite(u16 address, u8 val)
@@ -52,12 +76,17 @@ inline void HandleIOWrite(u16 address, u8 val)
 	SpecialRegister special_register = SpecialRegister(address);
 	switch (special_register)
 	{
+	case SpecialRegister::JOYPAD: Joypad::W_P1(val); break;
+	case SpecialRegister::SERIAL_DATA: Serial::W_SB(val); break;
+	case SpecialRegister::SERIAL_CONTROL: Serial::W_SC(val); break;
+
 	case SpecialRegister::DIV:	Timer::W_DIV(val);	break;
 	case SpecialRegister::TIMA: Timer::W_TIMA(val); break;
 	case SpecialRegister::TMA:	Timer::W_TMA(val);	break;
 	case SpecialRegister::TAC:	Timer::W_TAC(val);	break;
 
-	case SpecialRegister::INTERRUPT_FLAG:
+	case SpecialRegister::INTERRUPT_FLAG: Interrupts::W_IF(val); break;
+
 	case SpecialRegister::SOUND_NR11:
 	case SpecialRegister::SOUND_NR12:
 	case SpecialRegister::SOUND_NR13:
@@ -69,11 +98,17 @@ inline void HandleIOWrite(u16 address, u8 val)
 		// todo
 		break;
 	}
-	case SpecialRegister::VIDEO_LCD_CONTROL:
-	case SpecialRegister::VIDEO_LCD_STATUS:
-	case SpecialRegister::VIDEO_SCROLLY:
-	case SpecialRegister::VIDEO_SCROLLX:
-	case SpecialRegister::VIDEO_BG_PALETTE:
+	case SpecialRegister::VIDEO_LCD_CONTROL:	PPU::W_LCDC(val);	break;
+	case SpecialRegister::VIDEO_LCD_STATUS:		PPU::W_STAT(val);	break;
+	case SpecialRegister::VIDEO_SCROLLY:		PPU::W_SCY(val);	break;
+	case SpecialRegister::VIDEO_SCROLLX:		PPU::W_SCX(val);	break;
+	case SpecialRegister::VIDEO_BG_PALETTE:		PPU::W_BGP(val);	break;
+	case SpecialRegister::VIDEO_SPRITE0_PALETTE:	PPU::W_OBP0(val);	break;
+	case SpecialRegister::VIDEO_SPRITE1_PALETTE:	PPU::W_OBP1(val);	break;
+	case SpecialRegister::VIDEO_OAM_DMA:		PPU::W_DMA(val);	break;
+	case SpecialRegister::VIDEO_WINDOW_Y:		PPU::W_WY(val);		break;
+	case SpecialRegister::VIDEO_WINDOW_X:		PPU::W_WX(val);		break;
+
 	case SpecialRegister::BOOTROM_SWITCH:
 	{
 		Memory::StoreU8(address, val);
@@ -87,6 +122,8 @@ inline void HandleIOWrite(u16 address, u8 val)
 
 u8 Bus::LoadU8(u16 address)
 {
+	INSTRUMENT_SCOPE(BUS_LOAD);
+
 	if (InRange(address, AddressRegion::BOOTROM_START, AddressRegion::BOOTROM_END))
 	{
 		// Either bootrom or cart rom
@@ -135,9 +172,7 @@ u8 Bus::LoadU8(u16 address)
 	else if (InRange(address, AddressRegion::OAM_START, AddressRegion::OAM_END))
 	{
 		// Sprite Attrib Memory (OAM)
-		// todo
-		assert(false);
-		return 0;
+		return Memory::LoadU8(address);
 	}
 	else if (InRange(address, AddressRegion::OAM_END, AddressRegion::IO_START))
 	{
@@ -159,12 +194,14 @@ u8 Bus::LoadU8(u16 address)
 	{
 		assert(address == (u16)SpecialRegister::INTERRUPT_ENABLE);
 		// Interrupt Enable Register
-		return Memory::LoadU8(address);
+		return Interrupts::R_IE();
 	}
 }
 
 void Bus::StoreU8(u16 address, u8 val)
 {
+	INSTRUMENT_SCOPE(BUS_STORE);
+
 	if (InRange(address, AddressRegion::SELECT_START, AddressRegion::SELECT_END))
 	{
 		// 32KB ROM space
@@ -173,29 +210,30 @@ void Bus::StoreU8(u16 address, u8 val)
 	else if (InRange(address, AddressRegion::VRAM_START, AddressRegion::VRAM_END))
 	{
 		// 8KB Video RAM
-		Memory::StoreU8(address, val);
+		StoreRAM(address, val);
+		TileCache::NotifyStore(address);
+		PPU::NotifyVRAMStore();
 	}
 	else if (InRange(address, AddressRegion::RAMBANK_SWITCHABLE_START, AddressRegion::RAMBANK_SWITCHABLE_END))
 	{
 		// 8KB switchable RAM bank
 		// todo handle RAM bank switching
-		Memory::StoreU8(address, val);
+		StoreRAM(address, val);
 	}
 	else if (InRange(address, AddressRegion::RAMBANK_INTERNAL_START, AddressRegion::RAMBANK_INTERNAL_END))
 	{
 		// 8KB Internal RAM
-		Memory::StoreU8(address, val);
+		StoreRAM(address, val);
 	}
 	else if (InRange(address, AddressRegion::RAMBANK_INTERNAL_ECHO_START, AddressRegion::RAMBANK_INTERNAL_ECHO_END))
 	{
 		// echo of 8KB Internal RAM
-		Memory::StoreU8(address - ((u16)AddressRegion::RAMBANK_INTERNAL_ECHO_START - (u16)AddressRegion::RAMBANK_INTERNAL_START), val);
+		StoreRAM(address - ((u16)AddressRegion::RAMBANK_INTERNAL_ECHO_START - (u16)AddressRegion::RAMBANK_INTERNAL_START), val);
 	}
 	else if (InRange(address, AddressRegion::OAM_START, AddressRegion::OAM_END))
 	{
 		// Sprite Attrib Memory (OAM)
-		// todo
-		assert(false);
+		PPU::W_OAM(address, val);
 	}
 	else if (InRange(address, AddressRegion::OAM_END, AddressRegion::IO_START))
 	{
@@ -210,13 +248,13 @@ void Bus::StoreU8(u16 address, u8 val)
 	else if (InRange(address, AddressRegion::ZEROPAGE_START, AddressRegion::ZEROPAGE_END))
 	{
 		// Internal RAM
-		Memory::StoreU8(address, val);
+		StoreRAM(address, val);
 	}
 	else
 	{
 		assert(address == (u16)SpecialRegister::INTERRUPT_ENABLE);
 		// Interrupt Enable Register
-		Memory::StoreU8(address, val);
+		Interrupts::W_IE(val);
 	}
 }
 
@@ -0,0 +1,158 @@
+#include "blockcopy.h"
+
+#include "Bus.h"
+#include "cartridge.h"
+#include "codecache.h"
+#include "constants.h"
+#include "emulator.h"
+#include "memory.h"
+#include "operations.h"
+#include "ppu.h"
+#include "tilecache.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Host memory behind [address, address + size) if it is all RAM the CPU can store to without side effects
+static u8* MapRAM(u16 address, u32 size)
+{
+	const u32 end = u32(address) + size;
+	if (address >= (u16)AddressRegion::VRAM_START && end <= (u32)AddressRegion::RAMBANK_INTERNAL_END)
+	{
+		// VRAM, external RAM and internal RAM sit next to each other
+		return &Memory::memory[address];
+	}
+	if (address >= (u16)AddressRegion::RAMBANK_INTERNAL_ECHO_START && end <= (u32)AddressRegion::RAMBANK_INTERNAL_ECHO_END)
+	{
+		return &Memory::memory[address - ((u16)AddressRegion::RAMBANK_INTERNAL_ECHO_START - (u16)AddressRegion::RAMBANK_INTERNAL_START)];
+	}
+	if (address >= (u16)AddressRegion::ZEROPAGE_START && end <= (u32)AddressRegion::ZEROPAGE_END)
+	{
+		return &Memory::memory[address];
+	}
+	return nullptr;
+}
+
+// Like MapRAM, but also allows reading from a single rom bank
+static const u8* MapSource(u16 address, u32 size)
+{
+	const u32 end = u32(address) + size;
+	if (end <= (u32)AddressRegion::ROMBANK_STATIC_END)
+	{
+		if (address < (u16)AddressRegion::BOOTROM_END && !Memory::LoadU8((u16)SpecialRegister::BOOTROM_SWITCH))
+		{
+			return nullptr;
+		}
+		return Cartridge::GetRomPointer(address);
+	}
+	if (address >= (u16)AddressRegion::ROMBANK_SWITCHABLE_START && end <= (u32)AddressRegion::ROMBANK_SWITCHABLE_END)
+	{
+		return Cartridge::GetRomPointer(address);
+	}
+	return MapRAM(address, size);
+}
+
+// Iterations that can run before an interrupt, the frame end or the PPU could notice the difference
+static u32 Limit(u32 count, u32 iterationCycles)
+{
+	if (Interrupts::enableDelay > -1 || Interrupts::disableDelay > -1)
+	{
+		return 0;
+	}
+
+	// CatchUp has to finish before the last cycle of the frame
+	u64 cycles = Emulator::GetCyclesToFrameEnd() - 1;
+	if (Interrupts::masterEnable)
+	{
+		if (Interrupts::pending)
+		{
+			return 0;
+		}
+		// An enabled interrupt raised before the last iteration ends would be serviced in the middle. Serial and
+		// joypad interrupts only come from IO stores and the host between frames, which can't happen in between.
+		const u8 enabled = Interrupts::R_IE() & (u8)INTERRUPT_FLAGS::ANY;
+		if (enabled & (u8)INTERRUPT_FLAGS::TIMER)
+		{
+			const u64 clock = Emulator::GetClock();
+			cycles = std::min(cycles, Timer::nextInterrupt > clock ? Timer::nextInterrupt - clock : 0);
+		}
+		cycles = std::min<u64>(cycles, PPU::GetCyclesWithoutInterrupts(enabled));
+	}
+	return u32(std::min<u64>(count, cycles / iterationCycles));
+}
+
+// Cuts count down so the stores to [begin, begin + count) are still safe, see the conditions in blockcopy.h
+static u32 LimitDestination(u16 begin, u32 count, u32 iterationCycles)
+{
+	const u32 end = u32(begin) + count;
+	if (begin < (u16)AddressRegion::VRAM_END && end > (u32)AddressRegion::VRAM_START)
+	{
+		count = std::min(count, PPU::GetCyclesWithoutVRAMReads() / iterationCycles);
+	}
+	for (u32 page = begin >> CodeCache::PAGE_SHIFT; page <= (end - 1) >> CodeCache::PAGE_SHIFT; ++page)
+	{
+		if (CodeCache::watchedPages[page])
+		{
+			return 0;
+		}
+	}
+	return count;
+}
+
+u32 BlockCopy::Copy(u16 dest, u16 source, u32 count, u32 iterationCycles)
+{
+	count = Limit(count, iterationCycles);
+	if (count == 0 || u32(dest) + count > 0x10000 || u32(source) + count > 0x10000)
+	{
+		return 0;
+	}
+	count = LimitDestination(dest, count, iterationCycles);
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	u8* to = MapRAM(dest, count);
+	const u8* from = MapSource(source, count);
+	if (!to || !from || (to < from + count && from < to + count))
+	{
+		return 0;
+	}
+
+	memcpy(to, from, count);
+	TileCache::InvalidateRange(dest, u32(dest) + count);
+	Emulator::CatchUp(count * iterationCycles);
+	return count;
+}
+
+u32 BlockCopy::Fill(u16 dest, u8 value, u32 count, u32 iterationCycles, bool descending)
+{
+	count = Limit(count, iterationCycles);
+	if (count == 0 || (descending ? u32(dest) + 1 < count : u32(dest) + count > 0x10000))
+	{
+		return 0;
+	}
+	const u16 begin = descending ? u16(dest + 1 - count) : dest;
+	u32 limited = LimitDestination(begin, count, iterationCycles);
+	if (limited == 0)
+	{
+		return 0;
+	}
+	if (descending && limited < count)
+	{
+		// Counting down, the bytes the PPU is safe from are the ones nearest dest
+		return Fill(dest, value, limited, iterationCycles, descending);
+	}
+
+	u8* to = MapRAM(begin, limited);
+	if (!to)
+	{
+		return 0;
+	}
+
+	memset(to, value, limited);
+	TileCache::InvalidateRange(begin, u32(begin) + limited);
+	Emulator::CatchUp(limited * iterationCycles);
+	return limited;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "types.h"
+
+// Bulk transfers for the copy and fill loops in the fusion catalogue. Instead of running a loop byte by byte,
+// as many whole iterations as can't be told apart from the interpreter are done as one host memcpy/memset, then
+// the rest of the machine is caught up by the exact cycles those iterations would have taken.
+//
+// That only holds while nothing else looks at the bytes or the CPU mid loop, so a transfer runs no iterations
+// (and the loop runs instruction by instruction) when:
+//  - either range touches rom (as a destination), OAM, the unusable region, IO or IE
+//  - IME is about to change, or an interrupt is already due
+//  - the destination covers VRAM the PPU would fetch from before the loop finishes
+//  - the destination covers a page holding cached code, see CodeCache
+//  - the source and destination overlap
+// and it stops short of the end of the frame and, with IME set, of the first cycle an enabled timer, VBlank or STAT
+// interrupt could be raised on.
+namespace BlockCopy
+{
+	// Runs up to count iterations of a loop copying one byte per iterationCycles from source to dest, both counting
+	// up. Returns the iterations run, which can be fewer than asked for or 0.
+	u32 Copy(u16 dest, u16 source, u32 count, u32 iterationCycles);
+
+	// The same for a loop storing value, counting down from dest when descending
+	u32 Fill(u16 dest, u8 value, u32 count, u32 iterationCycles, bool descending);
+}
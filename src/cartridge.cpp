@@ -7,57 +7,152 @@
 #include <fstream>
 #include <assert.h>
 
-extern u8 memory[0x10000];
+const u16 CARTRIDGE_TYPE_ADDRESS = 0x0147;
+const int ROM_BANK_SIZE = 0x4000;
 
 std::string Cartridge::rom_path = "";
-u8* rom_data = nullptr;
-int rom_size;
+static Cartridge::Rom game_rom;
+
+static thread_local Cartridge::Rom inserted_rom;
+static thread_local const u8* rom_data = nullptr;
+static thread_local int rom_size;
+static thread_local bool has_mbc1 = false;
+
+static thread_local Cartridge::State mbc;
+static thread_local int switchable_bank_offset = 0; // added to 0x4000-0x7FFF addresses to find the selected bank
+
+Cartridge::Rom Cartridge::LoadRom(const std::string& path)
+{
+	std::ifstream file;
+	file.open(path, std::iostream::in | std::iostream::binary | std::iostream::ate);
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	auto size = static_cast<std::size_t>(file.tellg());
+	if (size < ROM_BANK_SIZE)
+	{
+		return nullptr;
+	}
+	auto rom = std::make_shared<std::vector<u8>>(size);
+	file.seekg(0, std::iostream::beg);
+	file.read((char*)rom->data(), size);
+	return rom;
+}
 
 void Cartridge::LoadGameRom()
 {
 	assert(!rom_path.empty() && "Specify \"-gamerom something\" on cmdline");
 
-	// Load in the raw file
-	{
-		std::ifstream file;
-		file.open(rom_path, std::iostream::in | std::iostream::binary | std::iostream::ate);
-		assert(file && "Can't find gamerom");
+	game_rom = LoadRom(rom_path);
+	assert(game_rom && "Can't find gamerom");
+}
 
-		rom_size = static_cast<int>(file.tellg());
-		assert(rom_size > 0);
-		rom_data = new u8[rom_size];
-		file.seekg(0, std::iostream::beg);
-		file.read((char*)rom_data, rom_size);
-		file.close();
-	}
+void Cartridge::Insert(const Rom& rom)
+{
+	inserted_rom = rom;
+}
+
+Cartridge::Rom Cartridge::GetInserted()
+{
+	return inserted_rom;
+}
+
+static int GetSwitchableBank()
+{
+	int bank = mbc.romBankLow ? mbc.romBankLow : 1;
+	bank |= mbc.bankHigh << 5;
+	return bank % (rom_size / ROM_BANK_SIZE);
+}
+
+static void UpdateSwitchableBank()
+{
+	switchable_bank_offset = (GetSwitchableBank() - 1) * ROM_BANK_SIZE;
+}
+
+void Cartridge::Init()
+{
+	const Rom& rom = inserted_rom ? inserted_rom : game_rom;
+	assert(rom);
+	rom_data = rom->data();
+	rom_size = static_cast<int>(rom->size());
 
 	// Pull out the various metadata values we need to know
-	// todo
+	u8 cartridge_type = rom_data[CARTRIDGE_TYPE_ADDRESS];
+	has_mbc1 = cartridge_type >= 0x01 && cartridge_type <= 0x03;
+
+	mbc = {};
+	UpdateSwitchableBank();
 }
 
 u8 Cartridge::LoadU8(u16 address)
 {
-	assert(address < rom_size);
-	return rom_data[address];
+	int offset = address;
+	if (InRange(address, AddressRegion::ROMBANK_SWITCHABLE_START, AddressRegion::ROMBANK_SWITCHABLE_END))
+	{
+		offset += switchable_bank_offset;
+	}
+	assert(offset < rom_size);
+	return rom_data[offset];
+}
+
+const u8* Cartridge::GetRomPointer(u16 address)
+{
+	int offset = address;
+	if (InRange(address, AddressRegion::ROMBANK_SWITCHABLE_START, AddressRegion::ROMBANK_SWITCHABLE_END))
+	{
+		offset += switchable_bank_offset;
+	}
+	assert(offset < rom_size);
+	return rom_data + offset;
+}
+
+u8 Cartridge::GetBank(u16 address)
+{
+	if (InRange(address, AddressRegion::ROMBANK_SWITCHABLE_START, AddressRegion::ROMBANK_SWITCHABLE_END))
+	{
+		return (u8)GetSwitchableBank();
+	}
+	return 0;
+}
+
+void Cartridge::SaveState(State& state)
+{
+	state = mbc;
+}
+
+void Cartridge::LoadState(const State& state)
+{
+	mbc = state;
+	UpdateSwitchableBank();
 }
 
 void Cartridge::StoreU8(u16 address, u8 val)
 {
-	assert(false);
-	if (InRange(address, AddressRegion::ROMBANK_STATIC_START, AddressRegion::ROMBANK_STATIC_END))
+	if (!has_mbc1)
+	{
+		// Rom only cartridges ignore writes
+		return;
+	}
+
+	if (InRange(address, AddressRegion::RAMBANK_ENABLE_START, AddressRegion::RAMBANK_ENABLE_END))
 	{
 		// TODO RAM Bank Enable
 	}
 	else if (InRange(address, AddressRegion::ROMBANK_SELECT_START, AddressRegion::ROMBANK_SELECT_END))
 	{
-		// TODO ROM Bank Select
+		mbc.romBankLow = val & 0x1F;
+		UpdateSwitchableBank();
 	}
 	else if (InRange(address, AddressRegion::RAMBANK_SELECT_START, AddressRegion::RAMBANK_SELECT_END))
 	{
-		// TODO RAM Bank Select
+		// Upper rom bank bits, or the RAM bank in mode 1. todo : RAM banking
+		mbc.bankHigh = val & 0x03;
+		UpdateSwitchableBank();
 	}
 	else if (InRange(address, AddressRegion::MBC1_SELECT_START, AddressRegion::MBC1_SELECT_END))
 	{
-		// TODO MBC1 ROM/RAM Select
+		mbc.bankingMode = val & 0x01;
 	}
-}
\ No newline at end of file
+}
@@ -1,13 +1,44 @@
 #pragma once
 #include "types.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace Cartridge
 {
+	typedef std::shared_ptr<const std::vector<u8>> Rom;
+
+	// MBC registers
+	struct State
+	{
+		u8 romBankLow;
+		u8 bankHigh;
+		u8 bankingMode;
+	};
+
+	// Resets the MBC and binds the calling thread's machine to its inserted rom, or the game rom if none was inserted
+	void Init();
+
 	u8 LoadU8(u16 address);
 	void StoreU8(u16 address, u8 val);
 
+	// Host memory a cpu address in 0x0000-0x7FFF currently maps to, valid up to the end of its 16KB bank
+	const u8* GetRomPointer(u16 address);
+
+	// The rom bank a cpu address currently maps to, as used by .sym files (00 for everything outside 0x4000-0x7FFF)
+	u8 GetBank(u16 address);
+
+	void SaveState(State& state);
+	void LoadState(const State& state);
+
+	// Loads rom_path as the game rom, shared read-only by every thread
 	void LoadGameRom();
 	extern std::string rom_path;
-}
\ No newline at end of file
+
+	// For running different roms side by side: load them up front, then Insert on the thread that runs each one
+	Rom LoadRom(const std::string& path);
+	void Insert(const Rom& rom);
+	// What the calling thread inserted, null if it runs the game rom
+	Rom GetInserted();
+}
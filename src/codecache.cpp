@@ -0,0 +1,135 @@
+#include "codecache.h"
+
+#include <algorithm>
+#include <vector>
+
+thread_local u8 CodeCache::watchedPages[CodeCache::PAGE_COUNT];
+
+struct TrackedBlock
+{
+	u16 begin;
+	u32 end;
+	CodeCache::InvalidateFunction invalidate;
+	void* context;
+	bool live;
+};
+
+// Handles are indices + 1 into blocks, dead slots are reused through free_blocks
+static thread_local std::vector<TrackedBlock> blocks;
+static thread_local std::vector<CodeCache::BlockHandle> free_blocks;
+static thread_local std::vector<CodeCache::BlockHandle> page_blocks[CodeCache::PAGE_COUNT];
+static thread_local u32 page_generations[CodeCache::PAGE_COUNT];
+static thread_local bool generation_pages[CodeCache::PAGE_COUNT]; // Watched for their generation alone
+
+static int FirstPage(u16 begin)
+{
+	return begin >> CodeCache::PAGE_SHIFT;
+}
+
+static int LastPage(u16 begin, u32 end)
+{
+	return int((std::max<u32>(end, begin + 1) - 1) >> CodeCache::PAGE_SHIFT);
+}
+
+void CodeCache::Init()
+{
+	blocks.clear();
+	free_blocks.clear();
+	for (int page = 0; page < PAGE_COUNT; ++page)
+	{
+		page_blocks[page].clear();
+		page_generations[page]++;
+		generation_pages[page] = false;
+		watchedPages[page] = 0;
+	}
+}
+
+CodeCache::BlockHandle CodeCache::Track(u16 begin, u32 end, InvalidateFunction invalidate, void* context)
+{
+	BlockHandle handle;
+	if (!free_blocks.empty())
+	{
+		handle = free_blocks.back();
+		free_blocks.pop_back();
+	}
+	else
+	{
+		blocks.emplace_back();
+		handle = (BlockHandle)blocks.size();
+	}
+	blocks[handle - 1] = { begin, end, invalidate, context, true };
+
+	for (int page = FirstPage(begin); page <= LastPage(begin, end); ++page)
+	{
+		page_blocks[page].push_back(handle);
+		watchedPages[page] = 1;
+	}
+	return handle;
+}
+
+void CodeCache::Untrack(BlockHandle handle)
+{
+	if (handle == INVALID_BLOCK || handle > blocks.size() || !blocks[handle - 1].live)
+	{
+		return;
+	}
+
+	TrackedBlock& block = blocks[handle - 1];
+	block.live = false;
+	for (int page = FirstPage(block.begin); page <= LastPage(block.begin, block.end); ++page)
+	{
+		std::vector<BlockHandle>& list = page_blocks[page];
+		list.erase(std::remove(list.begin(), list.end(), handle), list.end());
+		watchedPages[page] = !list.empty() || generation_pages[page];
+	}
+	free_blocks.push_back(handle);
+}
+
+void CodeCache::Watch(u16 begin, u32 end)
+{
+	for (int page = FirstPage(begin); page <= LastPage(begin, end); ++page)
+	{
+		generation_pages[page] = true;
+		watchedPages[page] = 1;
+	}
+}
+
+void CodeCache::InvalidateRange(u16 begin, u32 end)
+{
+	for (int page = FirstPage(begin); page <= LastPage(begin, end); ++page)
+	{
+		if (!watchedPages[page])
+		{
+			continue;
+		}
+		page_generations[page]++;
+
+		// Backwards, so Untrack only shifts entries already visited. A callback may untrack more of the page, or
+		// track new blocks onto its end, which are past the walk.
+		std::vector<BlockHandle>& list = page_blocks[page];
+		std::size_t index = list.size();
+		while (index > 0)
+		{
+			BlockHandle handle = list[--index];
+			const TrackedBlock& block = blocks[handle - 1];
+			if (block.live && block.begin < end && begin < block.end)
+			{
+				InvalidateFunction invalidate = block.invalidate;
+				void* context = block.context;
+				Untrack(handle);
+				invalidate(handle, context);
+				index = std::min(index, list.size());
+			}
+		}
+	}
+}
+
+u32 CodeCache::GetPageGeneration(u16 address)
+{
+	return page_generations[address >> PAGE_SHIFT];
+}
+
+void CodeCache::OnStore(u16 address)
+{
+	InvalidateRange(address, u32(address) + 1);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "types.h"
+
+// Bookkeeping for caches of decoded or compiled code built from RAM, so they hear about it when the bytes under
+// them change (routines copied to HRAM for OAM DMA, code run from WRAM, self-modifying code).
+//
+// Bus::StoreU8 checks a per page flag and only does any work for pages that hold tracked blocks, where it bumps
+// the page's generation counter and invalidates exactly the blocks covering the stored byte.
+namespace CodeCache
+{
+	const int PAGE_SHIFT = 8; // 256 byte pages
+	const int PAGE_COUNT = 0x10000 >> PAGE_SHIFT;
+
+	typedef u32 BlockHandle;
+	const BlockHandle INVALID_BLOCK = 0;
+
+	// Called once when a store (or InvalidateRange) hits a tracked block, after which the handle is dead
+	typedef void(*InvalidateFunction)(BlockHandle block, void* context);
+
+	// Non zero for pages with at least one tracked block
+	extern thread_local u8 watchedPages[PAGE_COUNT];
+
+	// Forgets every block without calling back, for when the machine is reset or restored
+	void Init();
+
+	// Starts watching the bytes [begin, end) that a cached block was built from
+	BlockHandle Track(u16 begin, u32 end, InvalidateFunction invalidate, void* context);
+	void Untrack(BlockHandle block);
+
+	// Makes stores to the pages under [begin, end) bump their generation without tracking a block, for caches that
+	// only validate lazily. Lasts until Init.
+	void Watch(u16 begin, u32 end);
+
+	// Invalidates every block overlapping [begin, end), for writes that don't go through Bus::StoreU8
+	void InvalidateRange(u16 begin, u32 end);
+
+	// Bumped by every store to a watched page, so a cache can also validate lazily by comparing generations
+	u32 GetPageGeneration(u16 address);
+
+	void OnStore(u16 address);
+
+	inline void NotifyStore(u16 address)
+	{
+		if (watchedPages[address >> PAGE_SHIFT])
+		{
+			OnStore(address);
+		}
+	}
+}
@@ -8,6 +8,9 @@ const int total_gb_display_bytes = gb_width * gb_height * bytes_per_pixel;
 
 enum class SpecialRegister : u16
 {
+	JOYPAD = 0xFF00,
+	SERIAL_DATA = 0xFF01,
+	SERIAL_CONTROL = 0xFF02,
 	DIV = 0xFF04,
 	TIMA = 0xFF05,
 	TMA = 0xFF06,
@@ -26,9 +29,12 @@ enum class SpecialRegister : u16
 	VIDEO_SCROLLY = 0xFF42,
 	VIDEO_SCROLLX = 0xFF43,
 	VIDEO_CURRENT_SCANLINE = 0xFF44,
+	VIDEO_OAM_DMA = 0xFF46,
 	VIDEO_BG_PALETTE = 0xFF47,
 	VIDEO_SPRITE0_PALETTE = 0xFF48,
 	VIDEO_SPRITE1_PALETTE = 0xFF49,
+	VIDEO_WINDOW_Y = 0xFF4A,
+	VIDEO_WINDOW_X = 0xFF4B,
 	BOOTROM_SWITCH = 0xFF50,
 	INTERRUPT_ENABLE = 0xFFFF,
 };
@@ -81,7 +87,7 @@ enum class AddressRegion : u16
 	TILE_PATTERN_TABLE_MODE_1_ELEMENT_0 = 0x8000,
 
 	VIDEO_REGISTER_BEGIN = (u16)SpecialRegister::VIDEO_LCD_CONTROL,
-	VIDEO_REGISTER_END = (u16)SpecialRegister::VIDEO_SPRITE1_PALETTE,
+	VIDEO_REGISTER_END = (u16)SpecialRegister::VIDEO_WINDOW_X + 1, // exclusive, WX is the last one
 };
 
 // VIDEO_LCD_CONTROL 0xFF40
@@ -1,6 +1,9 @@
 #pragma once
 #include "types.h"
 
+#include <array>
+#include <cstddef>
+
 struct Registers
 {
 	union
@@ -66,14 +69,28 @@ struct Registers
 	u16split temp;
 };
 
-extern Registers reg;
+extern thread_local Registers reg;
 
-enum class INTERRUPT_FLAGS : u8;
+typedef std::size_t(*operation)(void);
+extern const std::array<operation, 256> operations;
+extern const std::array<operation, 256> exops; // CB prefixed
 
 class CPU
 {
 public:
+	// Everything outside of the registers that affects execution, so it can be snapshotted
+	struct State
+	{
+		Registers reg;
+		bool halted;
+		bool repeatPCPostHalt;
+		std::size_t cycles;
+	};
+
+	static void Init();
 	static void Step();
-	static void RaiseInterrupt(INTERRUPT_FLAGS interrupt);
+
+	static void SaveState(State& state);
+	static void LoadState(const State& state);
 };
 
@@ -0,0 +1,81 @@
+#include "display.h"
+
+#include "constants.h"
+
+#include "SDL.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+const int BUFFER_INDEX_MASK = 0x03;
+const int BUFFER_FRESH = 0x04; // Set while the middle buffer holds a frame the render thread hasn't taken yet
+
+static u8 buffers[3][total_gb_display_bytes];
+
+// Each buffer is owned by one side at a time: the back one by the emulation thread, the front one by the render
+// thread. The middle one changes hands by swapping indices with middle_buffer.
+static int back_buffer = 0;
+static int front_buffer = 1;
+static std::atomic<int> middle_buffer(2);
+
+static int submitted_frames = 0;
+
+static std::atomic<bool> render_running(false);
+static std::thread render_thread;
+
+static void RenderLoop(SDL_Window* window)
+{
+	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, 0);
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, gb_width, gb_height);
+
+	while (render_running.load(std::memory_order_acquire))
+	{
+		if (!(middle_buffer.load(std::memory_order_acquire) & BUFFER_FRESH))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		front_buffer = middle_buffer.exchange(front_buffer, std::memory_order_acq_rel) & BUFFER_INDEX_MASK;
+		SDL_UpdateTexture(texture, nullptr, buffers[front_buffer], gb_width * bytes_per_pixel);
+		SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+		SDL_RenderPresent(renderer);
+	}
+
+	SDL_DestroyTexture(texture);
+	SDL_DestroyRenderer(renderer);
+}
+
+void Display::Start(SDL_Window* window)
+{
+	Stop();
+
+	back_buffer = 0;
+	front_buffer = 1;
+	middle_buffer = 2;
+	submitted_frames = 0;
+	render_running = true;
+	render_thread = std::thread(RenderLoop, window);
+}
+
+void Display::Stop()
+{
+	if (!render_thread.joinable())
+	{
+		return;
+	}
+
+	render_running = false;
+	render_thread.join();
+}
+
+void Display::Submit(const u8* frame)
+{
+	// One sequential copy per presented frame, the emulator draws into memory of its own
+	memcpy(buffers[back_buffer], frame, total_gb_display_bytes);
+	back_buffer = middle_buffer.exchange(back_buffer | BUFFER_FRESH, std::memory_order_acq_rel) & BUFFER_INDEX_MASK;
+	SDL_Log("Frame %d", ++submitted_frames);
+}
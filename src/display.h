@@ -0,0 +1,20 @@
+#pragma once
+#include "types.h"
+
+struct SDL_Window;
+
+// Presents frames from a render thread of its own, so the emulation thread never waits on the renderer or VSYNC.
+// Frames are handed over through a lock-free triple buffer: submitting always has a free buffer to copy into, and the
+// render thread always shows the newest complete frame, dropping any it didn't get to in time. The only part of the
+// emulator that uses SDL, attached to the PPU as its presenter.
+namespace Display
+{
+	// Creates the renderer on the render thread and starts presenting
+	void Start(SDL_Window* window);
+	// Waits for the render thread to finish the frame it is on
+	void Stop();
+
+	// Copies a frame, ABGR8888 and gb_width x gb_height, into the back buffer and hands it over as the newest one.
+	// A PPU::Presenter, so only ever called from the emulation thread.
+	void Submit(const u8* frame);
+}
@@ -0,0 +1,285 @@
+#include "doctor.h"
+
+#include "Bus.h"
+#include "constants.h"
+#include "cpu.h"
+#include "emulator.h"
+#include "mappedfile.h"
+#include "memory.h"
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+
+thread_local bool Doctor::enabled = false;
+thread_local bool Doctor::stubLY = false;
+
+struct DoctorLine
+{
+	u8 a, f, b, c, d, e, h, l;
+	u16 sp, pc;
+	u8 pcmem[4];
+};
+
+static bool operator==(const DoctorLine& lhs, const DoctorLine& rhs)
+{
+	return lhs.a == rhs.a && lhs.f == rhs.f && lhs.b == rhs.b && lhs.c == rhs.c && lhs.d == rhs.d && lhs.e == rhs.e
+		&& lhs.h == rhs.h && lhs.l == rhs.l && lhs.sp == rhs.sp && lhs.pc == rhs.pc
+		&& lhs.pcmem[0] == rhs.pcmem[0] && lhs.pcmem[1] == rhs.pcmem[1] && lhs.pcmem[2] == rhs.pcmem[2] && lhs.pcmem[3] == rhs.pcmem[3];
+}
+
+struct Compared
+{
+	u64 cycle;
+	DoctorLine line;
+};
+
+static thread_local MappedLineReader reference;
+static thread_local DoctorLine expected;
+static thread_local bool expected_valid = false;
+static thread_local bool synced = false;
+static thread_local bool diverged = false;
+static thread_local bool finished = false;
+static thread_local u64 compared = 0;
+static thread_local unsigned context_lines = 8;
+static thread_local bool stub_ly_requested = false;
+static thread_local std::deque<Compared> history;
+static thread_local std::string report;
+
+static int HexDigit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+// Reads the hex digits following "<key>:" starting the search at cursor
+static bool ParseField(const char*& cursor, const char* end, const char* key, unsigned& value)
+{
+	std::size_t key_length = strlen(key);
+	while (cursor + key_length < end)
+	{
+		if (memcmp(cursor, key, key_length) == 0 && cursor[key_length] == ':')
+		{
+			cursor += key_length + 1;
+			value = 0;
+			int digits = 0;
+			for (int digit; cursor < end && (digit = HexDigit(*cursor)) >= 0; ++cursor, ++digits)
+			{
+				value = value << 4 | digit;
+			}
+			return digits > 0;
+		}
+		++cursor;
+	}
+	return false;
+}
+
+static bool ParseLine(const char* begin, const char* end, DoctorLine& line)
+{
+	unsigned a, f, b, c, d, e, h, l, sp, pc, mem;
+	const char* cursor = begin;
+	if (!ParseField(cursor, end, "A", a) || !ParseField(cursor, end, "F", f)
+		|| !ParseField(cursor, end, "B", b) || !ParseField(cursor, end, "C", c)
+		|| !ParseField(cursor, end, "D", d) || !ParseField(cursor, end, "E", e)
+		|| !ParseField(cursor, end, "H", h) || !ParseField(cursor, end, "L", l)
+		|| !ParseField(cursor, end, "SP", sp) || !ParseField(cursor, end, "PC", pc)
+		|| !ParseField(cursor, end, "PCMEM", mem))
+	{
+		return false;
+	}
+
+	line.a = (u8)a; line.f = (u8)f; line.b = (u8)b; line.c = (u8)c;
+	line.d = (u8)d; line.e = (u8)e; line.h = (u8)h; line.l = (u8)l;
+	line.sp = (u16)sp; line.pc = (u16)pc;
+	line.pcmem[0] = (u8)mem;
+	for (int i = 1; i < 4; ++i)
+	{
+		unsigned value = 0;
+		int digits = 0;
+		if (cursor < end && *cursor == ',')
+		{
+			++cursor;
+		}
+		for (int digit; cursor < end && (digit = HexDigit(*cursor)) >= 0; ++cursor, ++digits)
+		{
+			value = value << 4 | digit;
+		}
+		if (!digits)
+		{
+			return false;
+		}
+		line.pcmem[i] = (u8)value;
+	}
+	return true;
+}
+
+// Skips blank lines and anything that isn't a state line, such as serial output interleaved by some emulators
+static bool ReadExpected()
+{
+	const char* begin;
+	const char* end;
+	while (reference.NextLine(begin, end))
+	{
+		if (ParseLine(begin, end, expected))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static DoctorLine CaptureLine(u16 pc)
+{
+	DoctorLine line;
+	line.a = reg.A; line.f = reg.F; line.b = reg.B; line.c = reg.C;
+	line.d = reg.D; line.e = reg.E; line.h = reg.H; line.l = reg.L;
+	line.sp = reg.SP;
+	line.pc = pc;
+	for (int i = 0; i < 4; ++i)
+	{
+		line.pcmem[i] = Bus::LoadU8(u16(pc + i));
+	}
+	return line;
+}
+
+static std::string FormatLine(const DoctorLine& line)
+{
+	char text[96];
+	snprintf(text, sizeof(text), "A:%02X F:%02X B:%02X C:%02X D:%02X E:%02X H:%02X L:%02X SP:%04X PC:%04X PCMEM:%02X,%02X,%02X,%02X",
+		line.a, line.f, line.b, line.c, line.d, line.e, line.h, line.l, line.sp, line.pc,
+		line.pcmem[0], line.pcmem[1], line.pcmem[2], line.pcmem[3]);
+	return text;
+}
+
+// Puts a caret under every character that differs between two formatted lines
+static std::string MarkDifferences(const std::string& lhs, const std::string& rhs)
+{
+	std::string marks(lhs.size(), ' ');
+	for (std::size_t i = 0; i < lhs.size() && i < rhs.size(); ++i)
+	{
+		if (lhs[i] != rhs[i])
+		{
+			marks[i] = '^';
+		}
+	}
+	marks.erase(marks.find_last_not_of(' ') + 1);
+	return marks;
+}
+
+static void BuildReport(const DoctorLine& actual)
+{
+	char header[128];
+	snprintf(header, sizeof(header), "Diverged at instruction %llu (log line %llu, cycle %llu)\n\n",
+		(unsigned long long)compared, (unsigned long long)reference.GetLineNumber(), (unsigned long long)Emulator::GetClock());
+	report = header;
+
+	for (const Compared& previous : history)
+	{
+		snprintf(header, sizeof(header), "  %12llu  ", (unsigned long long)previous.cycle);
+		report += header + FormatLine(previous.line) + "\n";
+	}
+
+	std::string expected_text = FormatLine(expected);
+	std::string actual_text = FormatLine(actual);
+	report += "\n  expected      " + expected_text + "\n";
+	report += "  actual        " + actual_text + "\n";
+	report += "                " + MarkDifferences(expected_text, actual_text) + "\n\n";
+
+	// The reference keeps going, which usually shows where the paths split
+	for (unsigned i = 0; i < context_lines && ReadExpected(); ++i)
+	{
+		report += "  reference     " + FormatLine(expected) + "\n";
+	}
+}
+
+bool Doctor::Start(const std::string& reference_path, unsigned context, bool stub_ly)
+{
+	Stop();
+
+	if (!reference.Open(reference_path))
+	{
+		return false;
+	}
+	context_lines = context;
+	stub_ly_requested = stub_ly;
+	history.clear();
+	report.clear();
+	compared = 0;
+	synced = false;
+	diverged = false;
+	finished = false;
+	expected_valid = ReadExpected();
+	if (!expected_valid)
+	{
+		reference.Close();
+		return false;
+	}
+
+	enabled = true;
+	return true;
+}
+
+void Doctor::Stop()
+{
+	enabled = false;
+	stubLY = false;
+	reference.Close();
+}
+
+void Doctor::CompareOpcode(u16 pc)
+{
+	if (!synced)
+	{
+		// Wait until the machine reaches the point the log starts at, with the boot rom mapped out
+		if (pc != expected.pc || (pc < 0x0100 && !Memory::LoadU8((u16)SpecialRegister::BOOTROM_SWITCH)))
+		{
+			return;
+		}
+		synced = true;
+		stubLY = stub_ly_requested;
+	}
+
+	DoctorLine actual = CaptureLine(pc);
+	if (!(actual == expected))
+	{
+		BuildReport(actual);
+		diverged = true;
+		Stop();
+		return;
+	}
+
+	history.push_back({ Emulator::GetClock(), actual });
+	if (history.size() > context_lines)
+	{
+		history.pop_front();
+	}
+	compared++;
+
+	if (!ReadExpected())
+	{
+		finished = true;
+		Stop();
+	}
+}
+
+bool Doctor::Diverged()
+{
+	return diverged;
+}
+
+bool Doctor::Finished()
+{
+	return finished;
+}
+
+u64 Doctor::GetComparedCount()
+{
+	return compared;
+}
+
+const std::string& Doctor::GetReport()
+{
+	return report;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "types.h"
+
+#include <string>
+
+// Differential testing against reference logs in the gameboy-doctor format, one line per opcode:
+//
+//   A:01 F:B0 B:00 C:13 D:00 E:D8 H:01 L:4D SP:FFFE PC:0100 PCMEM:00,C3,13,02
+//
+// The log is streamed from a memory mapped file and compared with the CPU state before every opcode,
+// stopping at the first divergence. Comparison starts once execution first reaches the PC on the log's
+// first line, so logs that skip the boot rom line up with a machine that runs it.
+namespace Doctor
+{
+	// Checked by the CPU before every opcode, so comparing costs a single branch when disabled
+	extern thread_local bool enabled;
+	// Set from the first compared opcode until comparing stops when Start asked for stub_ly. CPU reads
+	// of LY then return 0x90, while the PPU keeps counting lines as usual.
+	extern thread_local bool stubLY;
+
+	// Starts comparing the calling thread's machine. context is the number of instructions shown
+	// on either side of a divergence. stub_ly is for logs made with LY stuck at 0x90, as gameboy-doctor
+	// expects by default.
+	bool Start(const std::string& reference_path, unsigned context = 8, bool stub_ly = false);
+	void Stop();
+
+	void CompareOpcode(u16 pc);
+
+	bool Diverged();
+	// True once the reference log ran out without a divergence
+	bool Finished();
+	u64 GetComparedCount();
+	// Human readable window around the first divergence, empty until one happens
+	const std::string& GetReport();
+}
@@ -0,0 +1,99 @@
+#include "emulator.h"
+
+#include "cartridge.h"
+#include "codecache.h"
+#include "cpu.h"
+#include "fusion.h"
+#include "instrument.h"
+#include "interrupts.h"
+#include "joypad.h"
+#include "memory.h"
+#include "ppu.h"
+#include "recompiled.h"
+#include "serial.h"
+#include "tilecache.h"
+#include "timer.h"
+
+static thread_local u64 master_clock = 0;
+static thread_local u64 frame_end = ~0ULL; // only set while RunFrame runs
+
+const u64 MAX_INSTRUCTION_CYCLES = 24;
+
+void Emulator::Init()
+{
+	master_clock = 0;
+	INSTRUMENT_BEGIN();
+
+	CPU::Init();
+	Interrupts::Init();
+	Memory::Init();
+	CodeCache::Init();
+	TileCache::Init();
+	Fusion::Init();
+	Cartridge::Init();
+	Joypad::Init();
+	Serial::Init();
+	Timer::Init();
+	PPU::Init();
+
+	Recompiled::Bind();
+}
+
+void Emulator::Step()
+{
+	// The timer only needs to run when it is about to raise an interrupt, reads catch it up themselves
+	if (master_clock >= Timer::nextInterrupt)
+	{
+		Timer::Update();
+	}
+	if ((master_clock % 4) == 0)
+	{
+		CPU::Step();
+	}
+	PPU::Step();
+	master_clock++;
+}
+
+void Emulator::RunFrame()
+{
+	frame_end = master_clock - master_clock % CYCLES_PER_FRAME + CYCLES_PER_FRAME;
+	while (master_clock < frame_end)
+	{
+		Step();
+	}
+	frame_end = ~0ULL;
+	INSTRUMENT_END_FRAME();
+}
+
+void Emulator::CatchUp(std::size_t cycles)
+{
+	// Mirrors Step: the instruction ran between the timer and PPU::Step of the current cycle. Nothing can see a
+	// timer interrupt until the next instruction, so the timer is only caught up at the end
+	const u32 steps = cycles ? u32(cycles) : 1;
+	PPU::Advance(steps);
+	master_clock += steps;
+	if (master_clock >= Timer::nextInterrupt)
+	{
+		Timer::Update();
+	}
+}
+
+bool Emulator::CanRunAhead()
+{
+	return GetCyclesToFrameEnd() > MAX_INSTRUCTION_CYCLES;
+}
+
+u64 Emulator::GetCyclesToFrameEnd()
+{
+	return frame_end - master_clock;
+}
+
+u64 Emulator::GetClock()
+{
+	return master_clock;
+}
+
+void Emulator::SetClock(u64 value)
+{
+	master_clock = value;
+}
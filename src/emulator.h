@@ -0,0 +1,32 @@
+#pragma once
+#include "types.h"
+
+#include <cstddef>
+
+namespace Emulator
+{
+	// 154 lines of 114 * 4 cycles
+	const int CYCLES_PER_FRAME = 154 * 114 * 4;
+
+	// Initialises the machine owned by the calling thread. The boot rom and game rom are shared between
+	// threads, so load them once up front (or Cartridge::Insert a rom for this thread). Frames stay in memory unless
+	// a presenter is attached, see PPU::AttachPresenter.
+	void Init();
+
+	// Advance by a single 4mhz cycle
+	void Step();
+	// Runs up to the next frame boundary
+	void RunFrame();
+
+	// For recompiled and fused code, called from inside CPU::Step after an instruction ran: finishes the current cycle
+	// and runs everything but the CPU up to the cycle the next instruction would be dispatched on
+	void CatchUp(std::size_t cycles);
+	// Whether another instruction can run ahead like that without crossing the end of the frame, so frames end on
+	// the same cycle as when interpreting
+	bool CanRunAhead();
+	// Cycles left until RunFrame returns, or practically unlimited outside of it
+	u64 GetCyclesToFrameEnd();
+
+	u64 GetClock();
+	void SetClock(u64 clock);
+}
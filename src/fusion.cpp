@@ -0,0 +1,323 @@
+#include "fusion.h"
+
+#include "blockcopy.h"
+#include "cartridge.h"
+#include "codecache.h"
+#include "emulator.h"
+#include "memory.h"
+#include "operations.h"
+
+#include <cstdint>
+
+const int MAX_SEQUENCE_LENGTH = 6;
+
+// Decode cache per address: 0 unknown, 1 no match, else the catalogue index + 2. The high byte holds the rom bank
+// the result came from for 0x4000-0x7FFF.
+const u8 CACHE_UNKNOWN = 0;
+const u8 CACHE_NO_MATCH = 1;
+
+bool Fusion::candidates[256];
+
+static thread_local u16 decode_cache[0x10000];
+
+// Misses from 0x8000 up aren't tracked, most of RAM is one. They're stamped with MissGeneration instead and hold
+// until a store to either page their bytes came from changes it.
+static thread_local u32 miss_generations[0x8000];
+
+// The sequence being run, read by the steps
+static thread_local u16 fused_pc;
+static thread_local u8 fused_bank;
+static thread_local bool fused_overwritten;
+
+// One instruction of a sequence. Handlers fetch their operands from PC, so it points at OPERANDS (the offset just
+// past the opcode, or past the CB prefix and opcode) as the interpreter would have left it.
+template <u16 OPERANDS, operation HANDLER>
+struct Step
+{
+	static const u16 operands = OPERANDS;
+	static const operation handler;
+
+	static std::size_t Run()
+	{
+		reg.PC = u16(fused_pc + OPERANDS);
+		return HANDLER();
+	}
+};
+
+template <u16 OPERANDS, operation HANDLER>
+const operation Step<OPERANDS, HANDLER>::handler = HANDLER;
+
+template <class... STEPS>
+struct Sequence;
+
+template <class LAST>
+struct Sequence<LAST>
+{
+	static std::size_t Run()
+	{
+		return LAST::Run();
+	}
+
+	static bool Check(const u8* bytes)
+	{
+		bool extended = LAST::operands >= 2 && bytes[LAST::operands - 2] == 0xCB;
+		return (extended ? exops : operations)[bytes[LAST::operands - 1]] == LAST::handler;
+	}
+};
+
+template <class FIRST, class SECOND, class... REST>
+struct Sequence<FIRST, SECOND, REST...>
+{
+	static std::size_t Run()
+	{
+		std::size_t c = FIRST::Run();
+		// Stop at this boundary if the interpreter would have done something else here, or a store overwrote the sequence
+		if (!Recompiled::Continue(c, fused_bank) || fused_overwritten)
+		{
+			return 0;
+		}
+		return Sequence<SECOND, REST...>::Run();
+	}
+
+	static bool Check(const u8* bytes)
+	{
+		return Sequence<FIRST>::Check(bytes) && Sequence<SECOND, REST...>::Check(bytes);
+	}
+};
+
+// A sequence that loops back to its own start. Before it runs once through the steps, as many iterations as
+// possible are done in bulk by TRANSFER, see BlockCopy, which leaves the registers as the interpreter would have
+// at the top of the loop. The last iteration always runs through the steps so the exit state comes from the
+// handlers themselves.
+template <u8 LENGTH, bool(*TRANSFER)(), class SEQUENCE>
+struct Loop
+{
+	static std::size_t Run()
+	{
+		if (Bus::LoadU8(u16(fused_pc + LENGTH - 1)) == u8(-LENGTH) && TRANSFER() && !Emulator::CanRunAhead())
+		{
+			return 0;
+		}
+		return SEQUENCE::Run();
+	}
+};
+
+// LD A,(HL+) / LD (DE),A / INC E / JR NZ, up to the end of the 256 byte page
+static bool TransferCopyE()
+{
+	const u32 count = 0x100 - reg.E;
+	const u32 done = BlockCopy::Copy(reg.DE, reg.HL, count - 1, 8 + 8 + 4 + 12);
+	if (!done)
+	{
+		return false;
+	}
+	reg.HL += u16(done);
+	reg.E += u8(done);
+	reg.A = Bus::LoadU8(u16(reg.HL - 1));
+	SetFlags(0, 0, (u8(reg.E - 1) & 0x0F) == 0x0F, _);
+	return true;
+}
+
+// LD (HL+),A / DEC B / JR NZ, B bytes
+static bool TransferFillB()
+{
+	const u32 count = reg.B ? reg.B : 0x100;
+	const u32 done = BlockCopy::Fill(reg.HL, reg.A, count - 1, 8 + 4 + 12, false);
+	if (!done)
+	{
+		return false;
+	}
+	reg.HL += u16(done);
+	reg.B -= u8(done);
+	SetFlags(0, 1, (u8(reg.B + 1) & 0x0F) == 0, _);
+	return true;
+}
+
+// LD (HL-),A / BIT 7,H / JR NZ, down to 0x8000
+static bool TransferFillDown()
+{
+	if (reg.HL < 0x8000)
+	{
+		return false;
+	}
+	const u32 count = reg.HL - 0x7FFF;
+	const u32 done = BlockCopy::Fill(reg.HL, reg.A, count - 1, 8 + 8 + 12, true);
+	if (!done)
+	{
+		return false;
+	}
+	reg.HL -= u16(done);
+	SetFlags(0, 0, 1, _);
+	return true;
+}
+
+struct Pattern
+{
+	const char* name;
+	u8 length;
+	u8 bytes[MAX_SEQUENCE_LENGTH];
+	u8 mask[MAX_SEQUENCE_LENGTH]; // 0x00 for operand bytes that can be anything
+	Recompiled::Block run;
+	bool(*check)(const u8* bytes);
+};
+
+#define SEQUENCE(...) Sequence<__VA_ARGS__>::Run, Sequence<__VA_ARGS__>::Check
+#define LOOP(LENGTH, TRANSFER, ...) Loop<LENGTH, TRANSFER, Sequence<__VA_ARGS__>>::Run, Sequence<__VA_ARGS__>::Check
+
+// Ordered by how often they showed up in traces of the boot rom and cpu_instrs. Every opcode that starts a sequence
+// costs a lookup wherever it runs, so only sequences that measurably pay for that in gbemu_bench stay in.
+static const Pattern catalogue[] =
+{
+	// Polling LY or STAT until it reaches a value
+	{ "LDH A,(n) / CP n / JR NZ", 6, { 0xF0, 0, 0xFE, 0, 0x20, 0 }, { 0xFF, 0, 0xFF, 0, 0xFF, 0 },
+		SEQUENCE(Step<1, LDH<A,$(a8), 12>>, Step<3, CP<A,d8, 8>>, Step<5, JR<NZ,r8, 12,8>>) },
+	// Delay loops
+	{ "SUB n / JR NC", 4, { 0xD6, 0, 0x30, 0 }, { 0xFF, 0, 0xFF, 0 },
+		SEQUENCE(Step<1, SUB<A,d8, 8>>, Step<3, JR<NC,r8, 12,8>>) },
+	// Copy until E wraps
+	{ "LD A,(HL+) / LD (DE),A / INC E / JR NZ", 5, { 0x2A, 0x12, 0x1C, 0x20, 0 }, { 0xFF, 0xFF, 0xFF, 0xFF, 0 },
+		LOOP(5, TransferCopyE, Step<1, LD<A,i(HL), 8>>, Step<2, LD<$(DE),A, 8>>, Step<3, INC<E, 4>>, Step<4, JR<NZ,r8, 12,8>>) },
+	// Clears
+	{ "LD (HL+),A / DEC B / JR NZ", 4, { 0x22, 0x05, 0x20, 0 }, { 0xFF, 0xFF, 0xFF, 0 },
+		LOOP(4, TransferFillB, Step<1, LD<i(HL),A, 8>>, Step<2, DEC<B, 4>>, Step<3, JR<NZ,r8, 12,8>>) },
+	{ "LD (HL-),A / BIT 7,H / JR NZ", 5, { 0x32, 0xCB, 0x7C, 0x20, 0 }, { 0xFF, 0xFF, 0xFF, 0xFF, 0 },
+		LOOP(5, TransferFillDown, Step<1, LD<d(HL),A, 8>>, Step<3, BIT<7,H, 8>>, Step<4, JR<NZ,r8, 12,8>>) },
+};
+
+#undef SEQUENCE
+#undef LOOP
+
+const int CATALOGUE_SIZE = sizeof(catalogue) / sizeof(catalogue[0]);
+
+static void BuildCandidates(bool enabled)
+{
+	for (bool& candidate : Fusion::candidates)
+	{
+		candidate = false;
+	}
+	if (!enabled)
+	{
+		return;
+	}
+	for (const Pattern& pattern : catalogue)
+	{
+		// Every step must be the very handler the interpreter would dispatch
+		assert(pattern.check(pattern.bytes));
+		Fusion::candidates[pattern.bytes[0]] = true;
+	}
+}
+
+static const bool candidates_built = (BuildCandidates(true), true);
+
+void Fusion::SetEnabled(bool enabled)
+{
+	BuildCandidates(enabled);
+}
+
+void Fusion::Init()
+{
+	for (u16& entry : decode_cache)
+	{
+		entry = CACHE_UNKNOWN;
+	}
+	fused_overwritten = false;
+}
+
+static void DropCachedDecode(CodeCache::BlockHandle, void* context)
+{
+	u16 address = (u16)(std::uintptr_t)context;
+	decode_cache[address] = CACHE_UNKNOWN;
+	if (address == fused_pc)
+	{
+		fused_overwritten = true;
+	}
+}
+
+static u32 MissGeneration(u16 address)
+{
+	u16 last = u16(address + MAX_SEQUENCE_LENGTH - 1);
+	u32 generation = CodeCache::GetPageGeneration(address);
+	if ((last >> CodeCache::PAGE_SHIFT) != (address >> CodeCache::PAGE_SHIFT))
+	{
+		generation += CodeCache::GetPageGeneration(last);
+	}
+	return generation;
+}
+
+static u8 Match(u16 address)
+{
+	u8 bytes[MAX_SEQUENCE_LENGTH];
+	for (int i = 0; i < MAX_SEQUENCE_LENGTH; ++i)
+	{
+		bytes[i] = Bus::LoadU8(u16(address + i));
+	}
+
+	for (int index = 0; index < CATALOGUE_SIZE; ++index)
+	{
+		const Pattern& pattern = catalogue[index];
+		int i = 0;
+		while (i < pattern.length && (bytes[i] & pattern.mask[i]) == pattern.bytes[i])
+		{
+			++i;
+		}
+		if (i == pattern.length)
+		{
+			return u8(index + 2);
+		}
+	}
+	return CACHE_NO_MATCH;
+}
+
+Recompiled::Block Fusion::Find(u16 address)
+{
+	// Stay clear of IO and anything that would wrap around the address space
+	if ((address >= 0xFE00 && address < 0xFF80) || address > 0x10000 - MAX_SEQUENCE_LENGTH)
+	{
+		return nullptr;
+	}
+
+	u8 result;
+	u8 bank = Cartridge::GetBank(address);
+	if (address < 0x0100 && !Memory::LoadU8((u16)SpecialRegister::BOOTROM_SWITCH))
+	{
+		// Not cached, the boot rom is mapped over the cartridge here
+		result = Match(address);
+	}
+	else
+	{
+		u16 entry = decode_cache[address];
+		bool stale = (entry & 0xFF) == CACHE_UNKNOWN || (entry >> 8) != bank;
+		if (!stale && (entry & 0xFF) == CACHE_NO_MATCH && address >= 0x8000)
+		{
+			stale = miss_generations[address - 0x8000] != MissGeneration(address);
+		}
+
+		if (stale)
+		{
+			entry = u16(bank << 8 | Match(address));
+			decode_cache[address] = entry;
+			if (address >= 0x8000)
+			{
+				if ((entry & 0xFF) == CACHE_NO_MATCH)
+				{
+					CodeCache::Watch(address, u32(address) + MAX_SEQUENCE_LENGTH);
+					miss_generations[address - 0x8000] = MissGeneration(address);
+				}
+				else
+				{
+					CodeCache::Track(address, u32(address) + MAX_SEQUENCE_LENGTH, DropCachedDecode, (void*)(std::uintptr_t)address);
+				}
+			}
+		}
+		result = u8(entry & 0xFF);
+	}
+
+	if (result == CACHE_NO_MATCH)
+	{
+		return nullptr;
+	}
+	fused_pc = address;
+	fused_bank = bank;
+	fused_overwritten = false;
+	return catalogue[result - 2].run;
+}
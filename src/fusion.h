@@ -0,0 +1,24 @@
+#pragma once
+#include "recompiled.h"
+#include "types.h"
+
+// Fused superinstructions. A fixed catalogue of opcode sequences that dominate test rom profiles (LY polling,
+// delay loops, copy and clear loops) is recognised when the CPU fetches their first opcode and run through one
+// handler that calls each instruction's template in turn. Between instructions the rest of the machine catches
+// up exactly as if they were dispatched one by one, see Recompiled::Continue, so cycles and visible state match
+// the interpreter.
+namespace Fusion
+{
+	// Opcodes that start a sequence in the catalogue, so every other opcode pays a single table lookup
+	extern bool candidates[256];
+
+	// Process wide, rebuilds candidates
+	void SetEnabled(bool enabled);
+
+	// Clears the calling thread's decode cache, for a reset machine or newly inserted rom
+	void Init();
+
+	// The fused handler for the sequence at address, or null. Results are cached per address; those in RAM are
+	// tracked through CodeCache so stores to the bytes drop them again.
+	Recompiled::Block Find(u16 address);
+}
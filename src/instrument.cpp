@@ -0,0 +1,117 @@
+#include "instrument.h"
+
+#ifdef GBEMU_INSTRUMENT
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+struct FrameRecord
+{
+	u64 startTicks;
+	u64 endTicks;
+	Instrument::Counters counters;
+};
+
+static const char* subsystem_names[] = { "cpu", "ppu", "timer", "bus_load", "bus_store", "present" };
+static_assert(sizeof(subsystem_names) / sizeof(subsystem_names[0]) == (int)Instrument::SUBSYSTEM::NUM_SUBSYSTEMS, "missing subsystem name");
+
+thread_local Instrument::Counters Instrument::current_frame = {};
+
+static thread_local std::vector<FrameRecord> frames;
+static thread_local u64 frame_start_ticks = 0;
+
+// Calibrates ticks against wall time over the whole recording, which is all rdtsc needs on an invariant tsc
+static thread_local u64 calibration_ticks = 0;
+static thread_local std::chrono::steady_clock::time_point calibration_time;
+
+void Instrument::Begin()
+{
+	frames.clear();
+	current_frame = {};
+	calibration_time = std::chrono::steady_clock::now();
+	calibration_ticks = Now();
+	frame_start_ticks = calibration_ticks;
+}
+
+void Instrument::EndFrame()
+{
+	u64 now = Now();
+	frames.push_back({ frame_start_ticks, now, current_frame });
+	current_frame = {};
+	frame_start_ticks = now;
+}
+
+static double MicrosecondsPerTick()
+{
+	double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - calibration_time).count();
+	u64 elapsed_ticks = Instrument::Now() - calibration_ticks;
+	return elapsed_ticks ? elapsed_us / elapsed_ticks : 0.0;
+}
+
+bool Instrument::WriteCsv(const std::string& path)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	const double us_per_tick = MicrosecondsPerTick();
+
+	fprintf(file, "frame,frame_us");
+	for (const char* name : subsystem_names)
+	{
+		fprintf(file, ",%s_calls,%s_us", name, name);
+	}
+	fprintf(file, "\n");
+
+	for (std::size_t i = 0; i < frames.size(); ++i)
+	{
+		const FrameRecord& frame = frames[i];
+		fprintf(file, "%zu,%.3f", i, (frame.endTicks - frame.startTicks) * us_per_tick);
+		for (int s = 0; s < (int)SUBSYSTEM::NUM_SUBSYSTEMS; ++s)
+		{
+			fprintf(file, ",%llu,%.3f", frame.counters.calls[s], frame.counters.ticks[s] * us_per_tick);
+		}
+		fprintf(file, "\n");
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool Instrument::WriteChromeTrace(const std::string& path)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file || frames.empty())
+	{
+		if (file)
+		{
+			fclose(file);
+		}
+		return false;
+	}
+
+	const double us_per_tick = MicrosecondsPerTick();
+	const u64 origin = frames.front().startTicks;
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	for (std::size_t i = 0; i < frames.size(); ++i)
+	{
+		const FrameRecord& frame = frames[i];
+		const double ts = (frame.startTicks - origin) * us_per_tick;
+
+		fprintf(file, "%s{\"name\":\"frame %zu\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", i ? ",\n" : "", i, ts, (frame.endTicks - frame.startTicks) * us_per_tick);
+		for (int s = 0; s < (int)SUBSYSTEM::NUM_SUBSYSTEMS; ++s)
+		{
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"us\":%.3f,\"calls\":%llu}}", subsystem_names[s], ts, frame.counters.ticks[s] * us_per_tick, frame.counters.calls[s]);
+		}
+	}
+	fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	fclose(file);
+	return true;
+}
+
+#endif
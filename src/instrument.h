@@ -0,0 +1,91 @@
+#pragma once
+#include "types.h"
+
+#include <string>
+
+// Host side timing of the emulator's subsystems, aggregated per frame.
+// Build with GBEMU_INSTRUMENT defined to enable it, otherwise every macro below compiles to nothing.
+// Times are inclusive, so CPU includes the Bus accesses it makes.
+
+#ifdef GBEMU_INSTRUMENT
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GBEMU_INSTRUMENT_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GBEMU_INSTRUMENT_RDTSC
+#else
+#include <chrono>
+#endif
+
+namespace Instrument
+{
+	enum class SUBSYSTEM
+	{
+		CPU,
+		PPU,
+		TIMER,
+		BUS_LOAD,
+		BUS_STORE,
+		PRESENT,
+
+		NUM_SUBSYSTEMS
+	};
+
+	struct Counters
+	{
+		u64 calls[(int)SUBSYSTEM::NUM_SUBSYSTEMS];
+		u64 ticks[(int)SUBSYSTEM::NUM_SUBSYSTEMS];
+	};
+
+	extern thread_local Counters current_frame;
+
+	inline u64 Now()
+	{
+#ifdef GBEMU_INSTRUMENT_RDTSC
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	class Scope
+	{
+	public:
+		explicit Scope(SUBSYSTEM subsystem) : subsystem(subsystem), start(Now()) {}
+		~Scope()
+		{
+			current_frame.calls[(int)subsystem]++;
+			current_frame.ticks[(int)subsystem] += Now() - start;
+		}
+
+	private:
+		SUBSYSTEM subsystem;
+		u64 start;
+	};
+
+	// Discards anything recorded so far and starts the first frame
+	void Begin();
+	// Closes the current frame's counters and starts the next
+	void EndFrame();
+
+	// One row per frame, times in microseconds
+	bool WriteCsv(const std::string& path);
+	// chrome://tracing / Perfetto: a complete event per frame plus per subsystem counter tracks
+	bool WriteChromeTrace(const std::string& path);
+}
+
+#define INSTRUMENT_CONCAT_INNER(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_INNER(a, b)
+#define INSTRUMENT_SCOPE(subsystem) Instrument::Scope INSTRUMENT_CONCAT(instrument_scope_, __LINE__)(Instrument::SUBSYSTEM::subsystem)
+#define INSTRUMENT_BEGIN() Instrument::Begin()
+#define INSTRUMENT_END_FRAME() Instrument::EndFrame()
+
+#else
+
+#define INSTRUMENT_SCOPE(subsystem)
+#define INSTRUMENT_BEGIN()
+#define INSTRUMENT_END_FRAME()
+
+#endif
@@ -0,0 +1,105 @@
+#include "interrupts.h"
+#include "constants.h"
+
+#include <assert.h>
+
+thread_local u8 interruptFlags;		// FF0F IF
+thread_local u8 interruptEnable;	// FFFF IE
+
+thread_local u8 Interrupts::pending = 0;
+thread_local bool Interrupts::masterEnable = false;
+thread_local int Interrupts::enableDelay = -1;
+thread_local int Interrupts::disableDelay = -1;
+
+namespace Interrupts
+{
+	static void UpdatePending()
+	{
+		pending = interruptFlags & interruptEnable & (u8)INTERRUPT_FLAGS::ANY;
+	}
+
+	void Init()
+	{
+		interruptFlags = 0;
+		interruptEnable = 0;
+		masterEnable = false;
+		enableDelay = -1;
+		disableDelay = -1;
+		UpdatePending();
+	}
+
+	void Raise(INTERRUPT_FLAGS interrupt)
+	{
+		interruptFlags |= (u8)interrupt;
+		UpdatePending();
+	}
+
+	u16 Acknowledge()
+	{
+		assert(pending);
+
+		// Lowest bit first, VBLANK has the highest priority
+		int index = 0;
+		while (!(pending & (1 << index)))
+		{
+			index++;
+		}
+		interruptFlags &= ~(1 << index);
+		UpdatePending();
+		return (u16)AddressRegion::INTERRUPT_VECTOR_START + (0x08 * index);
+	}
+
+	void UpdateMasterEnable()
+	{
+		// Enable/Disable the master interrupt enable flag after a 1 opcode delay
+		if (enableDelay > -1)
+		{
+			if (enableDelay-- == 0)
+			{
+				masterEnable = true;
+			}
+		}
+		if (disableDelay > -1)
+		{
+			if (disableDelay-- == 0)
+			{
+				masterEnable = false;
+			}
+		}
+	}
+
+	void SaveState(State& state)
+	{
+		state.flags = interruptFlags;
+		state.enable = interruptEnable;
+		state.masterEnable = masterEnable;
+		state.enableDelay = enableDelay;
+		state.disableDelay = disableDelay;
+	}
+
+	void LoadState(const State& state)
+	{
+		interruptFlags = state.flags;
+		interruptEnable = state.enable;
+		masterEnable = state.masterEnable;
+		enableDelay = state.enableDelay;
+		disableDelay = state.disableDelay;
+		UpdatePending();
+	}
+
+	// The unused top bits of IF read back as set
+	u8 R_IF() { return interruptFlags | 0xE0; }
+	u8 R_IE() { return interruptEnable; }
+
+	void W_IF(u8 v)
+	{
+		interruptFlags = v & (u8)INTERRUPT_FLAGS::ANY;
+		UpdatePending();
+	}
+
+	void W_IE(u8 v)
+	{
+		interruptEnable = v;
+		UpdatePending();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "types.h"
+
+enum class INTERRUPT_FLAGS : u8;
+
+// Interrupt controller: owns IF (FF0F), IE (FFFF) and IME. IF & IE & 0x1F is kept in pending and only recomputed
+// when one of the registers changes, so checking for a due interrupt before each instruction (or for a halted CPU
+// to wake up) is a single test.
+namespace Interrupts
+{
+	struct State
+	{
+		u8 flags;
+		u8 enable;
+		bool masterEnable;
+		int enableDelay;
+		int disableDelay;
+	};
+
+	// Requested and enabled, whether or not IME is set
+	extern thread_local u8 pending;
+
+	// IME, and the countdowns EI and DI use to change it after the next instruction
+	extern thread_local bool masterEnable;
+	extern thread_local int enableDelay;
+	extern thread_local int disableDelay;
+
+	void Init();
+
+	void Raise(INTERRUPT_FLAGS interrupt);
+
+	// Clears the highest priority pending interrupt and returns its vector
+	u16 Acknowledge();
+
+	// Counts down a pending EI or DI, called before each instruction
+	void UpdateMasterEnable();
+
+	void SaveState(State& state);
+	void LoadState(const State& state);
+
+	u8 R_IF();
+	u8 R_IE();
+
+	void W_IF(u8 v);
+	void W_IE(u8 v);
+}
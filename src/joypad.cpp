@@ -0,0 +1,59 @@
+#include "joypad.h"
+#include "interrupts.h"
+#include "constants.h"
+
+thread_local u8 heldButtons;	// Joypad::BUTTON bits, 1 = held
+thread_local u8 lineSelect;		// FF00 P1 bits 4-5, 0 = selected
+
+namespace Joypad
+{
+	const u8 SELECT_DIRECTIONS = 0x10;
+	const u8 SELECT_BUTTONS = 0x20;
+
+	u8 SelectedButtons(u8 buttons)
+	{
+		u8 selected = 0;
+		if (!(lineSelect & SELECT_DIRECTIONS))
+		{
+			selected |= buttons & 0x0F;
+		}
+		if (!(lineSelect & SELECT_BUTTONS))
+		{
+			selected |= buttons >> 4;
+		}
+		return selected;
+	}
+
+	void Init()
+	{
+		heldButtons = 0;
+		lineSelect = SELECT_DIRECTIONS | SELECT_BUTTONS;
+	}
+
+	void SetButtons(u8 buttons)
+	{
+		// The interrupt fires on a high to low transition of any selected input line
+		u8 pressed = SelectedButtons(buttons) & ~SelectedButtons(heldButtons);
+		heldButtons = buttons;
+		if (pressed)
+		{
+			Interrupts::Raise(INTERRUPT_FLAGS::JOYPAD);
+		}
+	}
+
+	void SaveState(State& state)
+	{
+		state.buttons = heldButtons;
+		state.select = lineSelect;
+	}
+
+	void LoadState(const State& state)
+	{
+		heldButtons = state.buttons;
+		lineSelect = state.select;
+	}
+
+	u8 R_P1() { return 0xC0 | lineSelect | (~SelectedButtons(heldButtons) & 0x0F); }
+
+	void W_P1(u8 v) { lineSelect = v & (SELECT_DIRECTIONS | SELECT_BUTTONS); }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "types.h"
+
+namespace Joypad
+{
+	// Bitmask of held buttons. The low nibble is read through P14 (directions), the high nibble through P15 (buttons)
+	enum class BUTTON : u8
+	{
+		RIGHT = 0x01,
+		LEFT = 0x02,
+		UP = 0x04,
+		DOWN = 0x08,
+		A = 0x10,
+		B = 0x20,
+		SELECT = 0x40,
+		START = 0x80,
+	};
+
+	struct State
+	{
+		u8 buttons;
+		u8 select;
+	};
+
+	void Init();
+	void SetButtons(u8 buttons);
+
+	void SaveState(State& state);
+	void LoadState(const State& state);
+
+	u8 R_P1();
+	void W_P1(u8 v);
+}
@@ -1,17 +1,50 @@
+#include <algorithm>
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "bootrom.h"
 #include "cartridge.h"
 #include "constants.h"
-#include "cpu.h"
+#include "display.h"
+#include "emulator.h"
+#include "fusion.h"
+#include "instrument.h"
 #include "main.h"
-#include "memory.h"
-#include "timer.h"
+#include "pixelkernels.h"
 #include "ppu.h"
+#include "profiler.h"
+#include "recompiled.h"
+#include "trace.h"
 
 SDL_Window* g_window;
 
+static int num_frames = -1; // run forever
+static std::string profile_path;
+static std::string symbols_path;
+static std::string instrument_path;
+static std::string trace_path;
+
+void ParseColorScheme(const std::string& arg)
+{
+	if (arg == "green")
+	{
+		PPU::colorScheme = PPU::DMG_GREEN;
+		return;
+	}
+
+	PPU::ColorScheme scheme = PPU::GREYSCALE;
+	const char* text = arg.c_str();
+	for (int shade = 0; shade < 4 && *text; ++shade)
+	{
+		char* end;
+		const u32 rgb = strtoul(text, &end, 16);
+		scheme.shades[shade] = 0xFF000000 | ((rgb & 0xFF) << 16) | (rgb & 0xFF00) | ((rgb >> 16) & 0xFF);
+		text = *end == ',' ? end + 1 : end;
+	}
+	PPU::colorScheme = scheme;
+}
+
 void ParseArgs(int argc, char** argv)
 {
 	for (int i = 0; i < argc;)
@@ -21,6 +54,73 @@ void ParseArgs(int argc, char** argv)
 		{
 			Cartridge::rom_path = argv[i++];
 		}
+		else if (arg == "-frames")
+		{
+			num_frames = atoi(argv[i++]);
+		}
+		else if (arg == "-profile")
+		{
+			// Writes <path>.hotspots.txt and <path>.folded on exit
+			profile_path = argv[i++];
+		}
+		else if (arg == "-sym")
+		{
+			symbols_path = argv[i++];
+		}
+		else if (arg == "-trace")
+		{
+			// Binary per opcode trace, decode with gbemu_tracedump
+			trace_path = argv[i++];
+		}
+		else if (arg == "-instrument")
+		{
+			// Writes <path>.csv and <path>.trace.json on exit, needs a GBEMU_INSTRUMENT build
+			instrument_path = argv[i++];
+		}
+		else if (arg == "-interpret")
+		{
+			// Ignore recompiled code linked in for the rom, see gbemu_recompile
+			Recompiled::allowed = false;
+		}
+		else if (arg == "-scanline")
+		{
+			// Draw whole lines at a time instead of running the pixel fifo, see PPU::FIDELITY
+			PPU::fidelity = PPU::FIDELITY::SCANLINE;
+		}
+		else if (arg == "-frameskip")
+		{
+			// Draw one frame in N, "auto" to skip while running behind, or "request" to only draw the last frame of a
+			// run of -frames 2 or more
+			std::string policy = argv[i++];
+			if (policy == "auto")
+			{
+				PPU::frameSkip = PPU::FRAMESKIP::ADAPTIVE;
+			}
+			else if (policy == "request")
+			{
+				PPU::frameSkip = PPU::FRAMESKIP::ON_REQUEST;
+			}
+			else
+			{
+				PPU::frameSkip = PPU::FRAMESKIP::FIXED;
+				PPU::frameSkipInterval = std::max(1, atoi(policy.c_str()));
+			}
+		}
+		else if (arg == "-colors")
+		{
+			// "green" or four comma separated RRGGBB shades, lightest first
+			ParseColorScheme(argv[i++]);
+		}
+		else if (arg == "-nosimd")
+		{
+			// Scalar rendering kernels, see PixelKernels
+			PixelKernels::Select(PixelKernels::ISA::SCALAR);
+		}
+		else if (arg == "-nofusion")
+		{
+			// Dispatch every opcode on its own, see Fusion::Find
+			Fusion::SetEnabled(false);
+		}
 	}
 }
 
@@ -28,6 +128,13 @@ int main(int argc, char** argv)
 {
 	ParseArgs(argc, argv);
 
+	if (PPU::frameSkip == PPU::FRAMESKIP::ON_REQUEST && num_frames < 2)
+	{
+		// The last frame is requested a frame ahead, so a shorter or endless run would never draw anything
+		SDL_Log("-frameskip request needs -frames 2 or more");
+		return 1;
+	}
+
 	SDL_Init(SDL_INIT_VIDEO);
 	const int res_multiplier = 4;
 	g_window = SDL_CreateWindow(
@@ -40,23 +147,52 @@ int main(int argc, char** argv)
 	);
 	assert(g_window);
 
-	Memory::Init();
 	BootRom::LoadFromDisk();
 	Cartridge::LoadGameRom();
 
-	Timer::Init();
-	PPU::Init();
+	Emulator::Init();
+	Display::Start(g_window);
+	PPU::AttachPresenter(Display::Submit);
+
+	if (!profile_path.empty())
+	{
+		if (!symbols_path.empty())
+		{
+			Profiler::LoadSymbols(symbols_path);
+		}
+		Profiler::Enable();
+	}
+
+	if (!trace_path.empty())
+	{
+		Trace::Start(trace_path);
+	}
 
-	int clock = 0;
-	while (true)
+	for (int frame = 0; num_frames < 0 || frame < num_frames; ++frame)
 	{
-		Timer::Step(); // todo(luke) : where should this go in component ordering
-		if ((clock % 4) == 0)
+		// The PPU's frames don't line up with RunFrame's, asking early makes sure one is drawn in full by the end
+		if (frame + 2 == num_frames)
 		{
-			CPU::Step();
+			PPU::RequestFrame();
 		}
-		PPU::Step();
-		clock++;
+		Emulator::RunFrame();
+	}
+
+	Trace::Stop();
+	Display::Stop();
+
+	if (!profile_path.empty())
+	{
+		Profiler::WriteHotspotReport(profile_path + ".hotspots.txt");
+		Profiler::WriteCollapsedStacks(profile_path + ".folded");
+	}
+
+#ifdef GBEMU_INSTRUMENT
+	if (!instrument_path.empty())
+	{
+		Instrument::WriteCsv(instrument_path + ".csv");
+		Instrument::WriteChromeTrace(instrument_path + ".trace.json");
 	}
+#endif
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const u64 VIEW_SIZE = 64 * 1024 * 1024; // a multiple of the allocation granularity on every platform we care about
+
+MappedLineReader::~MappedLineReader()
+{
+	Close();
+}
+
+bool MappedLineReader::Open(const std::string& path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	fileHandle = file;
+	fileSize = (u64)size.QuadPart;
+	if (fileSize)
+	{
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle)
+		{
+			Close();
+			return false;
+		}
+	}
+#else
+	fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	fstat(fileDescriptor, &info);
+	fileSize = (u64)info.st_size;
+#endif
+
+	position = 0;
+	lineNumber = 0;
+	carry.clear();
+	return true;
+}
+
+void MappedLineReader::Close()
+{
+	UnmapView();
+#ifdef _WIN32
+	if (mappingHandle)
+	{
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+	if (fileHandle)
+	{
+		CloseHandle(fileHandle);
+		fileHandle = nullptr;
+	}
+#else
+	if (fileDescriptor >= 0)
+	{
+		close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+#endif
+	fileSize = 0;
+}
+
+bool MappedLineReader::MapView(u64 offset)
+{
+	UnmapView();
+
+	viewOffset = offset;
+	viewSize = std::min(VIEW_SIZE, fileSize - offset);
+#ifdef _WIN32
+	view = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, DWORD(offset >> 32), DWORD(offset & 0xFFFFFFFF), (SIZE_T)viewSize);
+#else
+	void* mapped = mmap(nullptr, (size_t)viewSize, PROT_READ, MAP_PRIVATE, fileDescriptor, (off_t)offset);
+	view = mapped == MAP_FAILED ? nullptr : (const char*)mapped;
+	if (view)
+	{
+		madvise(mapped, (size_t)viewSize, MADV_SEQUENTIAL);
+	}
+#endif
+	return view != nullptr;
+}
+
+void MappedLineReader::UnmapView()
+{
+	if (!view)
+	{
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(view);
+#else
+	munmap((void*)view, (size_t)viewSize);
+#endif
+	view = nullptr;
+}
+
+bool MappedLineReader::NextLine(const char*& begin, const char*& end)
+{
+	carry.clear();
+	bool carrying = false;
+
+	while (position < fileSize)
+	{
+		if (!view || position >= viewOffset + viewSize)
+		{
+			// Views start on VIEW_SIZE boundaries so the offset always satisfies the allocation granularity
+			if (!MapView(position - position % VIEW_SIZE))
+			{
+				return false;
+			}
+		}
+
+		const char* start = view + (position - viewOffset);
+		const char* view_end = view + viewSize;
+		const char* newline = (const char*)memchr(start, '\n', view_end - start);
+
+		if (!newline)
+		{
+			// The line continues into the next view
+			carry.append(start, view_end);
+			carrying = true;
+			position = viewOffset + viewSize;
+			continue;
+		}
+
+		position += (newline - start) + 1;
+		if (carrying)
+		{
+			carry.append(start, newline);
+			begin = carry.data();
+			end = carry.data() + carry.size();
+		}
+		else
+		{
+			begin = start;
+			end = newline;
+		}
+
+		if (end > begin && end[-1] == '\r')
+		{
+			--end;
+		}
+		lineNumber++;
+		return true;
+	}
+
+	if (carrying)
+	{
+		// Last line without a terminator
+		begin = carry.data();
+		end = carry.data() + carry.size();
+		lineNumber++;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "types.h"
+
+#include <string>
+
+// Streams a file of any size line by line through a sliding memory mapped view, so multi-gigabyte
+// files never have to fit in memory (or in a 32-bit address space).
+class MappedLineReader
+{
+public:
+	MappedLineReader() = default;
+	~MappedLineReader();
+
+	MappedLineReader(const MappedLineReader&) = delete;
+	MappedLineReader& operator=(const MappedLineReader&) = delete;
+
+	bool Open(const std::string& path);
+	void Close();
+
+	// Returns the next line without its terminator. The pointers stay valid until the next call.
+	bool NextLine(const char*& begin, const char*& end);
+
+	u64 GetLineNumber() const { return lineNumber; }
+
+private:
+	bool MapView(u64 offset);
+	void UnmapView();
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+	u64 fileSize = 0;
+
+	const char* view = nullptr;
+	u64 viewOffset = 0;		// file offset of view[0]
+	u64 viewSize = 0;
+	u64 position = 0;		// file offset of the next unread byte
+
+	std::string carry;		// a line that straddled two views
+	u64 lineNumber = 0;
+};
@@ -1,6 +1,6 @@
 #include "memory.h"
 
-u8 Memory::memory[0x10000];
+thread_local u8 Memory::memory[0x10000];
 
 void Memory::Init()
 {
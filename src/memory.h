@@ -4,7 +4,7 @@
 
 namespace Memory
 {
-	extern u8 memory[0x10000];
+	extern thread_local u8 memory[0x10000];
 
 	inline u8 LoadU8(u16 address)
 	{
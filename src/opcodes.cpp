@@ -0,0 +1,18 @@
+#include "opcodes.h"
+
+#include <utility>
+
+template <std::size_t... OPCODES>
+constexpr std::array<Opcodes::Info, 256> DecodeAll(std::index_sequence<OPCODES...>)
+{
+	return {{ Opcodes::Decode(u8(OPCODES))... }};
+}
+
+template <std::size_t... OPCODES>
+constexpr std::array<Opcodes::Info, 256> DecodeAllExtended(std::index_sequence<OPCODES...>)
+{
+	return {{ Opcodes::DecodeExtended(u8(OPCODES))... }};
+}
+
+const std::array<Opcodes::Info, 256> Opcodes::info = DecodeAll(std::make_index_sequence<256>());
+const std::array<Opcodes::Info, 256> Opcodes::extendedInfo = DecodeAllExtended(std::make_index_sequence<256>());
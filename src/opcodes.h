@@ -0,0 +1,295 @@
+#pragma once
+#include "types.h"
+
+#include <array>
+
+// Static description of every opcode, decoded from the opcode bit fields the way the hardware does it:
+//
+//   x = bits 7-6, y = bits 5-3, z = bits 2-0, p = y >> 1, q = y & 1
+//
+// operations[] and exops[] are generated from the same decode (see Operation in operations.h), so handler costs
+// can't drift from what is reported here. Decode is constexpr for compile time use, info[] and extendedInfo[]
+// hold the results for everything else (block caches, the recompiler, profilers, disassemblers).
+namespace Opcodes
+{
+	// Register bits for Info::reads and Info::writes
+	const u16 REG_A = 1 << 0;
+	const u16 REG_F = 1 << 1;
+	const u16 REG_B = 1 << 2;
+	const u16 REG_C = 1 << 3;
+	const u16 REG_D = 1 << 4;
+	const u16 REG_E = 1 << 5;
+	const u16 REG_H = 1 << 6;
+	const u16 REG_L = 1 << 7;
+	const u16 REG_SP = 1 << 8;
+	const u16 REG_PC = 1 << 9; // only for control flow, every instruction advances PC
+	const u16 REG_AF = REG_A | REG_F;
+	const u16 REG_BC = REG_B | REG_C;
+	const u16 REG_DE = REG_D | REG_E;
+	const u16 REG_HL = REG_H | REG_L;
+
+	enum class MEMORY_ACCESS : u8
+	{
+		NONE,
+		READ,			// through BC, DE, HL or an immediate address
+		WRITE,
+		READ_WRITE,		// read-modify-write of (HL)
+		IO_READ,		// LDH A,(a8) and LD A,(C), always 0xFF00-0xFFFF
+		IO_WRITE,
+		STACK_READ,		// POP, RET, RETI
+		STACK_WRITE,	// PUSH, CALL, RST
+	};
+
+	enum class FLOW : u8
+	{
+		NEXT,			// falls through to the next instruction
+		JUMP,			// JP a16 and JR r8
+		JUMP_INDIRECT,	// JP HL
+		CALL,			// CALL a16 and RST
+		RETURN,			// RET and RETI
+		HALT,
+		STOP,
+		IME,			// DI and EI, which change interrupt handling after the next instruction
+		PREFIX,			// CB, the actual instruction is in extendedInfo[]
+		INVALID,		// unused opcode, locks up the cpu
+	};
+
+	// Immediate operand following the opcode
+	enum class IMMEDIATE : u8
+	{
+		NONE,
+		D8,
+		D16,
+		A8,				// 0xFF00 + n
+		A16,
+		R8,				// signed, relative to the next instruction for JR
+	};
+
+	struct Info
+	{
+		u8 length;				// in bytes, including the CB prefix
+		u8 cycles;				// when there is no condition or it fails
+		u8 cyclesTaken;			// when the condition passes, same as cycles for unconditional instructions
+		u16 reads;				// REG_ bits
+		u16 writes;
+		MEMORY_ACCESS memory;
+		FLOW flow;
+		IMMEDIATE immediate;
+		bool conditional;
+	};
+
+	// The r[] operand field: B, C, D, E, H, L, (HL), A
+	const int R8_HL = 6;
+
+	constexpr u16 R8Bits(int index)
+	{
+		return index == 0 ? REG_B : index == 1 ? REG_C : index == 2 ? REG_D : index == 3 ? REG_E :
+			index == 4 ? REG_H : index == 5 ? REG_L : index == R8_HL ? REG_HL : REG_A;
+	}
+
+	// The rp[] operand field: BC, DE, HL, SP
+	constexpr u16 RPBits(int index)
+	{
+		return index == 0 ? REG_BC : index == 1 ? REG_DE : index == 2 ? REG_HL : REG_SP;
+	}
+
+	// The rp2[] operand field used by PUSH and POP: BC, DE, HL, AF
+	constexpr u16 RP2Bits(int index)
+	{
+		return index == 3 ? REG_AF : RPBits(index);
+	}
+
+	constexpr Info Make(u8 length, u8 cycles, u16 reads, u16 writes, MEMORY_ACCESS memory = MEMORY_ACCESS::NONE,
+		IMMEDIATE immediate = IMMEDIATE::NONE, FLOW flow = FLOW::NEXT)
+	{
+		return Info{ length, cycles, cycles, reads, writes, memory, flow, immediate, false };
+	}
+
+	constexpr Info Conditional(Info info, u8 cyclesTaken)
+	{
+		info.cyclesTaken = cyclesTaken;
+		info.reads |= REG_F;
+		info.conditional = true;
+		return info;
+	}
+
+	constexpr Info Decode(u8 opcode)
+	{
+		const int x = opcode >> 6;
+		const int y = (opcode >> 3) & 7;
+		const int z = opcode & 7;
+		const int p = y >> 1;
+		const int q = y & 1;
+
+		const Info invalid = Make(1, 4, 0, 0, MEMORY_ACCESS::NONE, IMMEDIATE::NONE, FLOW::INVALID);
+
+		if (x == 1)
+		{
+			if (y == R8_HL && z == R8_HL)
+			{
+				return Make(1, 4, 0, 0, MEMORY_ACCESS::NONE, IMMEDIATE::NONE, FLOW::HALT);
+			}
+			// LD r[y],r[z]
+			const bool memory = y == R8_HL || z == R8_HL;
+			return Make(1, memory ? 8 : 4, R8Bits(z) | (y == R8_HL ? REG_HL : 0), y == R8_HL ? 0 : R8Bits(y),
+				y == R8_HL ? MEMORY_ACCESS::WRITE : z == R8_HL ? MEMORY_ACCESS::READ : MEMORY_ACCESS::NONE);
+		}
+
+		if (x == 2)
+		{
+			// alu[y] A,r[z]: ADD ADC SUB SBC AND XOR OR CP
+			const bool carry = y == 1 || y == 3;
+			return Make(1, z == R8_HL ? 8 : 4, REG_A | R8Bits(z) | (carry ? REG_F : 0), y == 7 ? REG_F : REG_AF,
+				z == R8_HL ? MEMORY_ACCESS::READ : MEMORY_ACCESS::NONE);
+		}
+
+		if (x == 0)
+		{
+			switch (z)
+			{
+			case 0:
+				switch (y)
+				{
+				case 0: return Make(1, 4, 0, 0);
+				case 1: return Make(3, 20, REG_SP, 0, MEMORY_ACCESS::WRITE, IMMEDIATE::A16);
+				case 2: return Make(2, 4, 0, 0, MEMORY_ACCESS::NONE, IMMEDIATE::D8, FLOW::STOP);
+				case 3: return Make(2, 12, REG_PC, REG_PC, MEMORY_ACCESS::NONE, IMMEDIATE::R8, FLOW::JUMP);
+				default: return Conditional(Make(2, 8, REG_PC, REG_PC, MEMORY_ACCESS::NONE, IMMEDIATE::R8, FLOW::JUMP), 12);
+				}
+			case 1:
+				return q == 0
+					? Make(3, 12, 0, RPBits(p), MEMORY_ACCESS::NONE, IMMEDIATE::D16)		// LD rp,d16
+					: Make(1, 8, REG_HL | RPBits(p), REG_HL | REG_F);					// ADD HL,rp
+			case 2:
+			{
+				// LD (BC),A  LD (DE),A  LD (HL+),A  LD (HL-),A and the loads the other way around
+				const u16 pointer = p == 0 ? REG_BC : p == 1 ? REG_DE : REG_HL;
+				const u16 increments = p >= 2 ? REG_HL : 0;
+				return q == 0
+					? Make(1, 8, pointer | REG_A, increments, MEMORY_ACCESS::WRITE)
+					: Make(1, 8, pointer, increments | REG_A, MEMORY_ACCESS::READ);
+			}
+			case 3:
+				return Make(1, 8, RPBits(p), RPBits(p));									// INC rp / DEC rp
+			case 4:
+			case 5:
+				// INC r / DEC r
+				return y == R8_HL
+					? Make(1, 12, REG_HL | REG_F, REG_F, MEMORY_ACCESS::READ_WRITE)
+					: Make(1, 4, R8Bits(y) | REG_F, R8Bits(y) | REG_F);
+			case 6:
+				// LD r,d8
+				return y == R8_HL
+					? Make(2, 12, REG_HL, 0, MEMORY_ACCESS::WRITE, IMMEDIATE::D8)
+					: Make(2, 8, 0, R8Bits(y), MEMORY_ACCESS::NONE, IMMEDIATE::D8);
+			default:
+				switch (y)
+				{
+				case 0: case 1: return Make(1, 4, REG_A, REG_AF);						// RLCA RRCA
+				case 2: case 3: return Make(1, 4, REG_AF, REG_AF);						// RLA RRA through carry
+				case 4: return Make(1, 4, REG_AF, REG_AF);								// DAA
+				case 5: return Make(1, 4, REG_AF, REG_AF);								// CPL
+				case 6: return Make(1, 4, REG_F, REG_F);								// SCF
+				default: return Make(1, 4, REG_F, REG_F);								// CCF
+				}
+			}
+		}
+
+		// x == 3
+		switch (z)
+		{
+		case 0:
+			switch (y)
+			{
+			case 4: return Make(2, 12, REG_A, 0, MEMORY_ACCESS::IO_WRITE, IMMEDIATE::A8);
+			case 5: return Make(2, 16, REG_SP, REG_SP | REG_F, MEMORY_ACCESS::NONE, IMMEDIATE::R8);
+			case 6: return Make(2, 12, 0, REG_A, MEMORY_ACCESS::IO_READ, IMMEDIATE::A8);
+			case 7: return Make(2, 12, REG_SP, REG_HL | REG_F, MEMORY_ACCESS::NONE, IMMEDIATE::R8);
+			default: return Conditional(Make(1, 8, REG_SP, REG_SP | REG_PC, MEMORY_ACCESS::STACK_READ, IMMEDIATE::NONE, FLOW::RETURN), 20);
+			}
+		case 1:
+			if (q == 0)
+			{
+				return Make(1, 12, REG_SP, REG_SP | RP2Bits(p), MEMORY_ACCESS::STACK_READ);				// POP
+			}
+			switch (p)
+			{
+			case 0: return Make(1, 16, REG_SP, REG_SP | REG_PC, MEMORY_ACCESS::STACK_READ, IMMEDIATE::NONE, FLOW::RETURN);
+			case 1: return Make(1, 16, REG_SP, REG_SP | REG_PC, MEMORY_ACCESS::STACK_READ, IMMEDIATE::NONE, FLOW::RETURN);
+			case 2: return Make(1, 4, REG_HL, REG_PC, MEMORY_ACCESS::NONE, IMMEDIATE::NONE, FLOW::JUMP_INDIRECT);
+			default: return Make(1, 8, REG_HL, REG_SP);
+			}
+		case 2:
+			switch (y)
+			{
+			case 4: return Make(1, 8, REG_A | REG_C, 0, MEMORY_ACCESS::IO_WRITE);
+			case 5: return Make(3, 16, REG_A, 0, MEMORY_ACCESS::WRITE, IMMEDIATE::A16);
+			case 6: return Make(1, 8, REG_C, REG_A, MEMORY_ACCESS::IO_READ);
+			case 7: return Make(3, 16, 0, REG_A, MEMORY_ACCESS::READ, IMMEDIATE::A16);
+			default: return Conditional(Make(3, 12, 0, REG_PC, MEMORY_ACCESS::NONE, IMMEDIATE::A16, FLOW::JUMP), 16);
+			}
+		case 3:
+			switch (y)
+			{
+			case 0: return Make(3, 16, 0, REG_PC, MEMORY_ACCESS::NONE, IMMEDIATE::A16, FLOW::JUMP);
+			case 1: return Make(1, 4, 0, 0, MEMORY_ACCESS::NONE, IMMEDIATE::NONE, FLOW::PREFIX);
+			case 6: return Make(1, 4, 0, 0, MEMORY_ACCESS::NONE, IMMEDIATE::NONE, FLOW::IME);
+			case 7: return Make(1, 4, 0, 0, MEMORY_ACCESS::NONE, IMMEDIATE::NONE, FLOW::IME);
+			default: return invalid;
+			}
+		case 4:
+			if (y < 4)
+			{
+				return Conditional(Make(3, 12, REG_SP | REG_PC, REG_SP | REG_PC, MEMORY_ACCESS::STACK_WRITE, IMMEDIATE::A16, FLOW::CALL), 24);
+			}
+			return invalid;
+		case 5:
+			if (q == 0)
+			{
+				return Make(1, 16, REG_SP | RP2Bits(p), REG_SP, MEMORY_ACCESS::STACK_WRITE);				// PUSH
+			}
+			if (p == 0)
+			{
+				return Make(3, 24, REG_SP | REG_PC, REG_SP | REG_PC, MEMORY_ACCESS::STACK_WRITE, IMMEDIATE::A16, FLOW::CALL);
+			}
+			return invalid;
+		case 6:
+		{
+			// alu[y] A,d8
+			const bool carry = y == 1 || y == 3;
+			return Make(2, 8, REG_A | (carry ? REG_F : 0), y == 7 ? REG_F : REG_AF, MEMORY_ACCESS::NONE, IMMEDIATE::D8);
+		}
+		default:
+			return Make(1, 16, REG_SP | REG_PC, REG_SP | REG_PC, MEMORY_ACCESS::STACK_WRITE, IMMEDIATE::NONE, FLOW::CALL);	// RST y*8
+		}
+	}
+
+	// The instruction following a CB prefix
+	constexpr Info DecodeExtended(u8 opcode)
+	{
+		const int x = opcode >> 6;
+		const int y = (opcode >> 3) & 7;
+		const int z = opcode & 7;
+		const bool memory = z == R8_HL;
+
+		if (x == 1)
+		{
+			// BIT y,r[z] only reads its operand
+			return Make(2, memory ? 12 : 8, R8Bits(z) | REG_F, REG_F, memory ? MEMORY_ACCESS::READ : MEMORY_ACCESS::NONE);
+		}
+
+		const u16 operand = memory ? 0 : R8Bits(z);
+		const MEMORY_ACCESS access = memory ? MEMORY_ACCESS::READ_WRITE : MEMORY_ACCESS::NONE;
+		if (x == 0)
+		{
+			// rot[y] r[z]: RLC RRC RL RR SLA SRA SWAP SRL, RL and RR rotate through carry
+			const bool carry = y == 2 || y == 3;
+			return Make(2, memory ? 16 : 8, R8Bits(z) | (carry ? REG_F : 0), operand | REG_F, access);
+		}
+		// RES y,r[z] / SET y,r[z]
+		return Make(2, memory ? 16 : 8, R8Bits(z), operand, access);
+	}
+
+	extern const std::array<Info, 256> info;
+	extern const std::array<Info, 256> extendedInfo;
+}
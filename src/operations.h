@@ -0,0 +1,1177 @@
+#pragma once
+#include "Bus.h"
+#include "constants.h"
+#include "cpu.h"
+#include "interrupts.h"
+#include "math.h"
+#include "opcodes.h"
+#include "types.h"
+
+#include <array>
+#include <assert.h>
+#include <tuple>
+#include <utility>
+
+// The opcode handlers behind operations[] and exops[]: operand classes plus one template per instruction, each
+// returning its cost in cycles. They live in a header so generated code (see gbemu_recompile) can instantiate the
+// very same handlers the interpreter uses.
+
+// CPU state the handlers touch, owned by cpu.cpp
+extern thread_local bool bHalted;
+extern thread_local bool bRepeatPCPostHalt;
+
+
+class A
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.A; }
+	static void Set(u8 value) { reg.A = value; }
+};
+
+class F
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.F; }
+	static void Set(u8 value) { reg.F = value; }
+};
+
+class B
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.B; }
+	static void Set(u8 value) { reg.B = value; }
+};
+
+class C
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.C; }
+	static u16 GetAddr() { return 0xFF00 + reg.C; }
+	static void Set(u8 value) { reg.C = value; }
+	static bool IsMet() { return reg.F & (u8)Flags::C; }
+};
+
+class D
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.D; }
+	static void Set(u8 value) { reg.D = value; }
+};
+
+class E
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.E; }
+	static void Set(u8 value) { reg.E = value; }
+};
+
+class H
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.H; }
+	static void Set(u8 value) { reg.H = value; }
+	static bool IsMet() { return reg.F & (u8)Flags::H; }
+};
+
+class L
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get() { return reg.L; }
+	static void Set(u8 value) { reg.L = value; }
+};
+
+
+class AF {
+public:
+	static const std::size_t size = 16;
+	static u16 Get() { return reg.AF; }
+	static void Set(u16 v) { reg.AF = v; }
+};
+
+class BC {
+public:
+	static const std::size_t size = 16;
+	static u16 Get() { return reg.BC; }
+	static u16 GetAddr() { return Get(); }
+	static void Set(u16 v) { reg.BC = v; }
+};
+
+class DE {
+public:
+	static const std::size_t size = 16;
+	static u16 Get() { return reg.DE; }
+	static u16 GetAddr() { return Get(); }
+	static void Set(u16 v) { reg.DE = v; }
+};
+
+class HL {
+public:
+	static const std::size_t size = 16;
+	static u16 Get() { return reg.HL; }
+	static u16 GetAddr() { return Get(); }
+	static void Set(u16 v) { reg.HL = v; }
+};
+
+class SP {
+public:
+	static const std::size_t size = 16;
+	static u16 Get() { return reg.SP; }
+	static void Set(u16 v) { reg.SP = v; }
+};
+
+class PC {
+public:
+	static const std::size_t size = 16;
+	static u16 Get() { return reg.PC; }
+	static void Set(u16 v) { reg.PC = v; }
+};
+
+
+class d8
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get()
+	{
+		return Bus::LoadU8(reg.PC++);
+	}
+};
+
+class d16
+{
+public:
+	static const std::size_t size = 16;
+	static u16 Get()
+	{
+		u16split v;
+		v.L = Bus::LoadU8(reg.PC++);
+		v.H = Bus::LoadU8(reg.PC++);
+		return v.Full;
+	}
+};
+
+class a8 : public d8
+{
+public:
+	static u16 GetAddr() { return u16(0xFF00) + (u16)Get(); }
+};
+
+class a16 : public d16
+{
+public:
+	static u16 GetAddr() { return Get(); }
+};
+
+class r8
+{
+public:
+	static const std::size_t size = 8;
+	static s8 Get()
+	{
+		u8 v = Bus::LoadU8(reg.PC++);
+		return *reinterpret_cast<s8*>(&v);
+	}
+};
+
+
+class Z
+{
+public:
+	static bool IsMet()
+	{
+		return reg.F & (u8)Flags::Z;
+	}
+};
+
+class NZ
+{
+public:
+	static bool IsMet()
+	{
+		return (reg.F & (u8)Flags::Z) == false;
+	}
+};
+
+class NC
+{
+public:
+	static bool IsMet()
+	{
+		return (reg.F & (u8)Flags::C) == false;
+	}
+};
+
+
+template <class SRC>
+class UREF
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get()
+	{
+		u16 addr = SRC::GetAddr();
+		return Bus::LoadU8(addr);
+	}
+
+	static void Set(u8 value)
+	{
+		u16 addr = SRC::GetAddr();
+		Bus::StoreU8(addr, value);
+	}
+
+	static void Set(u16 value)
+	{
+		u16split split;
+		split.Full = value;
+
+		u16 addr = SRC::GetAddr();
+		Bus::StoreU8(addr++, split.L); // todo(luke) : is this the correct order L then H?
+		Bus::StoreU8(addr, split.H);
+	}
+};
+
+template <class SRC>
+class IREF
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get()
+	{
+		u16 addr = SRC::GetAddr();
+		SRC::Set(addr + 1);
+		return Bus::LoadU8(addr);
+	}
+
+	static void Set(u8 value)
+	{
+		u16 addr = SRC::GetAddr();
+		SRC::Set(addr + 1);
+		Bus::StoreU8(addr, value);
+	}
+};
+
+template <class SRC>
+class DREF
+{
+public:
+	static const std::size_t size = 8;
+	static u8 Get()
+	{
+		u16 addr = SRC::GetAddr();
+		SRC::Set(addr - 1);
+		return Bus::LoadU8(addr);
+	}
+
+	static void Set(u8 value)
+	{
+		u16 addr = SRC::GetAddr();
+		SRC::Set(addr - 1);
+		Bus::StoreU8(addr, value);
+	}
+};
+
+
+
+inline void SetFlags(int Z, int N, int H, int C) // todo(luke) : more efficient flag setting?
+{
+	if (Z < 0) { Z = (reg.F & (u8)Flags::Z) ? 1 : 0; }
+	if (N < 0) { N = (reg.F & (u8)Flags::N) ? 1 : 0; }
+	if (H < 0) { H = (reg.F & (u8)Flags::H) ? 1 : 0; }
+	if (C < 0) { C = (reg.F & (u8)Flags::C) ? 1 : 0; }
+
+	reg.F =
+		(Z ? (u8)Flags::Z : 0) |
+		(N ? (u8)Flags::N : 0) |
+		(H ? (u8)Flags::H : 0) |
+		(C ? (u8)Flags::C : 0) |
+		(reg.F & u8(0x0F));
+}
+
+const int _ = -1;
+
+
+inline void Push(u16 value)
+{
+	u16split s; s.Full = value;
+	Bus::StoreU8(--reg.SP, s.L);	// todo(luke) : verify that these writes are in the correct order
+	Bus::StoreU8(--reg.SP, s.H);
+}
+
+inline u16 Pop()
+{
+	u16split s;
+	s.H = Bus::LoadU8(reg.SP++);
+	s.L = Bus::LoadU8(reg.SP++);
+	return s.Full;
+}
+
+
+inline u8 Add(u8 a, u8 b, int carry)
+{
+	bool h;
+	bool c;
+	u8 r = 0;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		int index = 1 << i;
+		int abit = (a & index) ? 1 : 0;
+		int bbit = (b & index) ? 1 : 0;
+		int rbit = abit + bbit + carry;
+
+		carry = (rbit & 0b10) ? 1 : 0;
+		int v = (rbit & 0b01) ? index : 0;
+		r = r | v;
+	}
+	h = carry;
+
+	for (int i = 4; i < 8; ++i)
+	{
+		int index = 1 << i;
+		int abit = (a & index) ? 1 : 0;
+		int bbit = (b & index) ? 1 : 0;
+		int rbit = abit + bbit + carry;
+
+		carry = (rbit & 0b10) ? 1 : 0;
+		int v = (rbit & 0b01) ? index : 0;
+		r = r | v;
+	}
+	c = carry;
+
+	SetFlags(_, _, h, c);
+	return r;
+}
+
+inline u8 Sub(u8 a, u8 b, int carry)
+{
+	bool h;
+	bool c;
+	u8 r = 0;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		int index = 1 << i;
+		int abit = (a & index) ? 1 : 0;
+		int bbit = (b & index) ? 1 : 0;
+		int rbit = (abit - bbit) - carry;
+
+		carry = (rbit & 0x10) ? 1 : 0;
+		int v = (rbit & 0b01) ? index : 0;
+		r = r | v;
+	}
+	h = carry;
+
+	for (int i = 4; i < 8; ++i)
+	{
+		int index = 1 << i;
+		int abit = (a & index) ? 1 : 0;
+		int bbit = (b & index) ? 1 : 0;
+		int rbit = (abit - bbit) - carry;
+
+		carry = (rbit & 0x10) ? 1 : 0;
+		int v = (rbit & 0b01) ? index : 0;
+		r = r | v;
+	}
+	c = carry;
+
+	SetFlags(_, _, h, c);
+	return r;
+}
+
+
+
+template <std::size_t cost>
+std::size_t NOP()
+{
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t LD()
+{
+	auto a = SRC::Get();
+	DST::Set(a);
+	return cost;
+}
+
+template <class DST, std::size_t cost>
+std::size_t LD_SPr8()
+{
+	u16split as; as.Full = reg.SP;
+	u16split bs; bs.Full = r8::Get();
+	u16split r{ 0, 0 };
+
+	r.L = Add(as.L, bs.L, 0);
+	int carry = (reg.F & (u8)Flags::C) ? 1 : 0;
+	r.H = Add(as.H, bs.H, 0);
+	DST::Set(r.Full);
+
+	SetFlags(0, 0, _, _);
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t LDH()
+{
+	auto a = SRC::Get();
+	DST::Set(a);
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t ADD()
+{
+	if constexpr (DST::size == 8)
+	{
+		u8 a = DST::Get();
+		u8 b = SRC::Get();
+		u8 r = Add(a, b, 0);
+		DST::Set(r);
+
+		bool z = r == 0;
+		SetFlags(z, 0, _, _);
+		return cost;
+	}
+	else
+	{
+		u16split as; as.Full = DST::Get();
+		u16split bs; bs.Full = SRC::Get();
+		u16split r{ 0, 0 };
+
+		r.L = Add(as.L, bs.L, 0);
+		int carry = (reg.F & (u8)Flags::C) ? 1 : 0;
+		r.H = Add(as.H, bs.H, carry);
+		DST::Set(r.Full);
+
+		SetFlags(_, 0, _, _);
+		return cost;
+	}
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t ADC()
+{
+	u8 a = DST::Get();
+	u8 b = SRC::Get();
+	int carry = (reg.F & (u8)Flags::C) ? 1 : 0;
+	u8 r = Add(a, b, 0);
+	DST::Set(r);
+
+	bool z = r == 0;
+	SetFlags(z, 0, _, _);
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t SUB()
+{
+	u8 a = DST::Get();
+	u8 b = SRC::Get();
+	u8 r = Sub(a, b, 0);
+	DST::Set(r);
+
+	bool z = r == 0;
+	SetFlags(z, 1, _, _);
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t SBC()
+{
+	u8 a = DST::Get();
+	u8 b = SRC::Get();
+	int carry = (reg.F & (u8)Flags::C) ? 1 : 0;
+	u8 r = Sub(a, b, 0);
+	DST::Set(r);
+
+	bool z = r == 0;
+	SetFlags(z, 1, _, _);
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t AND()
+{
+	u8 a = DST::Get();
+	u8 b = SRC::Get();
+	u8 r = a & b;
+	DST::Set(r);
+
+	bool z = r == 0;
+	SetFlags(z, 0, 1, 0);
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t XOR()
+{
+	u8 a = DST::Get();
+	u8 b = SRC::Get();
+	u8 r = a ^ b;
+	DST::Set(r);
+
+	bool z = r == 0;
+	SetFlags(z, 0, 0, 0);
+	return cost;
+}
+
+template <class DST, class SRC, std::size_t cost>
+std::size_t OR()
+{
+	u8 a = DST::Get();
+	u8 b = SRC::Get();
+	u8 r = a | b;
+	DST::Set(r);
+
+	bool z = r == 0;
+	SetFlags(z, 0, 0, 0);
+	return cost;
+}
+
+template <class REG, class SRC, std::size_t cost>
+std::size_t CP()
+{
+	u8 a = REG::Get();
+	u8 b = SRC::Get();
+	u8 r = Sub(a, b, 0);
+
+	bool z = r == 0;
+	SetFlags(z, 1, _, _);
+	return cost;
+}
+
+template <class DST, std::size_t cost>
+std::size_t INC()
+{
+	if constexpr (DST::size == 8)
+	{
+		u8 a = DST::Get();
+		u8 r = a + 1;
+		DST::Set(r);
+
+		bool z = r == 0;
+		bool h = (a & 0x0F) == 0x0F;
+		SetFlags(z, 0, h, _);
+		return cost;
+	}
+	else
+	{
+		u16 a = DST::Get();
+		u16 r = a + 1;
+		DST::Set(r);
+
+		return cost;
+	}
+}
+
+template <class DST, std::size_t cost>
+std::size_t DEC()
+{
+	if constexpr (DST::size == 8)
+	{
+		u8 a = DST::Get();
+		u8 r = a - 1;
+		DST::Set(r);
+
+		bool z = r == 0;
+		bool h = (a & 0x0F) == 0; // todo(luke) : should this be set on carry or when not carrying?
+		SetFlags(z, 1, h, _);
+		return cost;
+	}
+	else
+	{
+		u16 a = DST::Get();
+		u16 r = a - 1;
+		DST::Set(r);
+
+		return cost;
+	}
+}
+
+template <class SRC, std::size_t cost>
+std::size_t RLC()
+{
+	u8 a = SRC::Get();
+	bool c = a & 0x80;
+	u8 r = (a << 1) | int(c);
+
+	SRC::Set(r);
+	bool z = r == 0;
+	SetFlags(z, 0, 0, c);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t RLCA()
+{
+	return RLC<A, cost>();
+}
+
+template <class SRC, std::size_t cost>
+std::size_t RL()
+{
+	u8 a = SRC::Get();
+	bool c = reg.F & u8(Flags::C);
+	u8 r = (a << 1) | int(c);
+
+	SRC::Set(r);
+	c = a & 0x80;
+	bool z = r == 0;
+	SetFlags(z, 0, 0, c);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t RLA()	// todo(luke) : check z flag output for other rotate on A operations
+{
+	std::size_t scost = RL<A, cost>();
+	SetFlags(0, _, _, _);
+	return scost;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t RRC()
+{
+	u8 a = SRC::Get();
+	bool c = a & 0x01;
+	u8 r = (a >> 1) | (c ? 0x80 : 0);
+
+	SRC::Set(r);
+	bool z = r == 0;
+	SetFlags(z, 0, 0, c);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t RRCA()
+{
+	return RRC<A, cost>();
+}
+
+template <class SRC, std::size_t cost>
+std::size_t RR()
+{
+	u8 a = SRC::Get();
+	bool c = reg.F & u8(Flags::C);
+	u8 r = (a >> 1) | (c ? 0x80 : 0);
+
+	SRC::Set(r);
+	c = a & 0x01;
+	bool z = r == 0;
+	SetFlags(z, 0, 0, c);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t RRA()
+{
+	return RR<A, cost>();
+}
+
+template <std::size_t cost>
+std::size_t DAA()
+{
+	// allows two binary coded decimal values to be added or subtracted using the normal ADD/SUB operations and store the result in A
+	// then DAA can be run restore the A register to the BCD representation of the result
+	// i assume this is used to scores/timers etc so they are easier to convert to individual decimal digit tiles
+
+	bool negative = (reg.F & (u8)Flags::N);
+	bool carry = (reg.F & (u8)Flags::C);
+	bool hcarry = (reg.F & (u8)Flags::H);
+
+	u8 a = A::Get();
+	bool c = false;
+
+	if (negative)
+	{
+		if (carry)
+		{
+			a -= 0x60;
+			c = true;
+		}
+		if (hcarry)
+		{
+			a -= 0x06;
+		}
+	}
+	else
+	{
+		if (carry || a > 0x99)
+		{
+			a += 0x60;
+			c = true;
+		}
+		if (hcarry || (a & 0xF0) > 0x09)
+		{
+			a += 0x06;
+		}
+	}
+
+	A::Set(a);
+	bool z = a == 0;
+	SetFlags(z, _, 0, c);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t CPL()
+{
+	u8 a = A::Get();
+	a = ~a;
+
+	A::Set(a);
+	SetFlags(_, 1, 1, _);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t SCF()
+{
+	SetFlags(_, 0, 0, 1);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t CCF()
+{
+	bool c = reg.F & (u8)Flags::C;
+	SetFlags(_, 0, 0, !c);
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t HALT()
+{
+	if (Interrupts::masterEnable)
+	{
+		bHalted = true;
+	}
+	else
+	{
+		// todo if (GB/SGB/GBP)		todo(vanrz) : implement what this is?
+		bRepeatPCPostHalt = true;
+	}
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t STOP()
+{
+	// todo(luke) : stop the cpu somehow
+	d8::Get(); // skip the padding byte
+	return cost;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t JR()
+{
+	u16 offset = SRC::Get();
+	reg.PC += offset;
+	return cost;
+}
+
+template <class CONDITION, class SRC, std::size_t pass, std::size_t fail>
+std::size_t JR()
+{
+	u16 offset = SRC::Get();
+	if (CONDITION::IsMet())
+	{
+		reg.PC += offset;
+		return pass;
+	}
+	else
+	{
+		return fail;
+	}
+}
+
+template <class SRC, std::size_t cost>
+std::size_t JP()
+{
+	u16 a = SRC::Get();
+	reg.PC = a;
+	return cost;
+}
+
+template <class CONDITION, class SRC, std::size_t pass, std::size_t fail>
+std::size_t JP()
+{
+	u16 a = SRC::Get();
+	if (CONDITION::IsMet())
+	{
+		reg.PC = a;
+		return pass;
+	}
+	else
+	{
+		return fail;
+	}
+}
+
+template <std::size_t cost>
+std::size_t RET()
+{
+	u16 a = Pop();
+	reg.PC = a;
+	return cost;
+}
+
+template <class CONDITION, std::size_t pass, std::size_t fail >
+std::size_t RET()
+{
+	if (CONDITION::IsMet())
+	{
+		u16 a = Pop();
+		reg.PC = a;
+		return pass;
+	}
+	else
+	{
+		return fail;
+	}
+}
+
+template <std::size_t cost>
+std::size_t RETI()
+{
+	u16 a = Pop();
+	reg.HL = a;
+	Interrupts::enableDelay = 1;
+	return cost;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t PUSH()
+{
+	u16 v = SRC::Get();
+	Push(v);
+	return cost;
+}
+
+template <class DST, std::size_t cost>
+std::size_t POP()
+{
+	u16 v = Pop();
+	DST::Set(v);
+	return cost;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t CALL()
+{
+	u16 a = SRC::Get();
+	Push(reg.PC);
+	reg.PC = a;
+	return cost;
+}
+
+template <class CONDITION, class SRC, std::size_t pass, std::size_t fail>
+std::size_t CALL()
+{
+	u16 a = SRC::Get();
+	if (CONDITION::IsMet())
+	{
+		Push(reg.PC);
+		reg.PC = a;
+		return pass;
+	}
+	else
+	{
+		return fail;
+	}
+}
+
+template <u16 addr, std::size_t cost>
+std::size_t RST()
+{
+	Push(reg.PC);
+	reg.PC = addr;
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t EI()
+{
+	Interrupts::enableDelay = 1;
+	return cost;
+}
+
+template <std::size_t cost>
+std::size_t DI()
+{
+	Interrupts::disableDelay = 1;
+	return cost;
+}
+
+inline std::size_t PREFIX_CB()
+{
+	u8 opcode = Bus::LoadU8(reg.PC++);
+	return exops[opcode]();
+}
+
+inline std::size_t __()
+{
+	assert(false);
+	return 4;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t SLA()
+{
+	u8 a = SRC::Get();
+	u8 r = a << 1;
+
+	SRC::Set(r);
+	bool c = a & 0x80;
+	bool z = r == 0;
+	SetFlags(z, 0, 0, c);
+	return cost;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t SRA()
+{
+	u8 a = SRC::Get();
+	u8 r = (a & 0x80) | ((a >> 1) & 0x7F);
+
+	SRC::Set(r);
+	bool c = a & 0x01;
+	bool z = r == 0;
+	SetFlags(z, 0, 0, c);
+	return cost;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t SWAP()
+{
+	u8 a = SRC::Get();
+	u8 r = ((a << 4) & 0xF0) | ((a >> 4) & 0x0F);
+
+	SRC::Set(r);
+	bool z = r == 0;
+	SetFlags(z, 0, 0, 0);
+	return cost;
+}
+
+template <class SRC, std::size_t cost>
+std::size_t SRL()
+{
+	u8 a = SRC::Get();
+	u8 r = (a >> 1) & 0x7F;
+
+	SRC::Set(r);
+	bool c = a & 0x01;
+	bool z = r == 0;
+	SetFlags(z, 0, 0, c);
+	return cost;
+}
+
+template <int I, class SRC, std::size_t cost>
+std::size_t BIT()
+{
+	u8 a = SRC::Get();
+	bool z = (a & (1 << I)) == 0;
+	SetFlags(z, 0, 1, _);
+	return cost;
+}
+
+template <int I, class SRC, std::size_t cost>
+std::size_t RES()
+{
+	u8 a = SRC::Get();
+	u8 r = a | (1 << I);
+
+	SRC::Set(r);
+	return cost;
+}
+
+template <int I, class SRC, std::size_t cost>
+std::size_t SET()
+{
+	u8 a = SRC::Get();
+	u8 r = a & ~(1 << I);
+
+	SRC::Set(r);
+	return cost;
+}
+
+
+#define $(_value_) UREF<_value_>
+#define i(_value_) IREF<_value_>
+#define d(_value_) DREF<_value_>
+
+// operations[] and exops[] are generated from the opcode bit fields, see Opcodes::Decode, which also provides
+// every handler's cost so the two can't disagree. Operation<0x3E>() is the handler the interpreter runs for 0x3E.
+
+// r[]: B, C, D, E, H, L, (HL), A
+template <int INDEX> using R8 = std::tuple_element_t<INDEX, std::tuple<B, C, D, E, H, L, $(HL), A>>;
+// rp[]: BC, DE, HL, SP
+template <int INDEX> using RP = std::tuple_element_t<INDEX, std::tuple<BC, DE, HL, SP>>;
+// rp2[]: BC, DE, HL, AF
+template <int INDEX> using RP2 = std::tuple_element_t<INDEX, std::tuple<BC, DE, HL, AF>>;
+// cc[]: NZ, Z, NC, C
+template <int INDEX> using CC = std::tuple_element_t<INDEX, std::tuple<NZ, Z, NC, C>>;
+// Memory operands of LD (rp),A and LD A,(rp): (BC), (DE), (HL+), (HL-)
+template <int INDEX> using RPI = std::tuple_element_t<INDEX, std::tuple<$(BC), $(DE), i(HL), d(HL)>>;
+
+// alu[]: ADD ADC SUB SBC AND XOR OR CP
+template <int INDEX, class SRC, std::size_t cost>
+constexpr operation Alu()
+{
+	if constexpr (INDEX == 0) { return ADD<A, SRC, cost>; }
+	else if constexpr (INDEX == 1) { return ADC<A, SRC, cost>; }
+	else if constexpr (INDEX == 2) { return SUB<A, SRC, cost>; }
+	else if constexpr (INDEX == 3) { return SBC<A, SRC, cost>; }
+	else if constexpr (INDEX == 4) { return AND<A, SRC, cost>; }
+	else if constexpr (INDEX == 5) { return XOR<A, SRC, cost>; }
+	else if constexpr (INDEX == 6) { return OR<A, SRC, cost>; }
+	else { return CP<A, SRC, cost>; }
+}
+
+// rot[]: RLC RRC RL RR SLA SRA SWAP SRL
+template <int INDEX, class SRC, std::size_t cost>
+constexpr operation Rotate()
+{
+	if constexpr (INDEX == 0) { return RLC<SRC, cost>; }
+	else if constexpr (INDEX == 1) { return RRC<SRC, cost>; }
+	else if constexpr (INDEX == 2) { return RL<SRC, cost>; }
+	else if constexpr (INDEX == 3) { return RR<SRC, cost>; }
+	else if constexpr (INDEX == 4) { return SLA<SRC, cost>; }
+	else if constexpr (INDEX == 5) { return SRA<SRC, cost>; }
+	else if constexpr (INDEX == 6) { return SWAP<SRC, cost>; }
+	else { return SRL<SRC, cost>; }
+}
+
+template <u8 OPCODE>
+constexpr operation Operation()
+{
+	constexpr int x = OPCODE >> 6;
+	constexpr int y = (OPCODE >> 3) & 7;
+	constexpr int z = OPCODE & 7;
+	constexpr int p = y >> 1;
+	constexpr int q = y & 1;
+	constexpr Opcodes::Info info = Opcodes::Decode(OPCODE);
+	constexpr std::size_t cost = info.cycles;
+	constexpr std::size_t taken = info.cyclesTaken;
+
+	if constexpr (info.flow == Opcodes::FLOW::INVALID) { return __; }
+	else if constexpr (x == 1)
+	{
+		if constexpr (info.flow == Opcodes::FLOW::HALT) { return HALT<cost>; }
+		else { return LD<R8<y>, R8<z>, cost>; }
+	}
+	else if constexpr (x == 2) { return Alu<y, R8<z>, cost>(); }
+	else if constexpr (x == 0)
+	{
+		if constexpr (z == 0)
+		{
+			if constexpr (y == 0) { return NOP<cost>; }
+			else if constexpr (y == 1) { return LD<$(a16), SP, cost>; }
+			else if constexpr (y == 2) { return STOP<cost>; }
+			else if constexpr (y == 3) { return JR<r8, cost>; }
+			else { return JR<CC<y - 4>, r8, taken, cost>; }
+		}
+		else if constexpr (z == 1)
+		{
+			if constexpr (q == 0) { return LD<RP<p>, d16, cost>; }
+			else { return ADD<HL, RP<p>, cost>; }
+		}
+		else if constexpr (z == 2)
+		{
+			if constexpr (q == 0) { return LD<RPI<p>, A, cost>; }
+			else { return LD<A, RPI<p>, cost>; }
+		}
+		else if constexpr (z == 3)
+		{
+			if constexpr (q == 0) { return INC<RP<p>, cost>; }
+			else { return DEC<RP<p>, cost>; }
+		}
+		else if constexpr (z == 4) { return INC<R8<y>, cost>; }
+		else if constexpr (z == 5) { return DEC<R8<y>, cost>; }
+		else if constexpr (z == 6) { return LD<R8<y>, d8, cost>; }
+		else
+		{
+			if constexpr (y == 0) { return RLCA<cost>; }
+			else if constexpr (y == 1) { return RRCA<cost>; }
+			else if constexpr (y == 2) { return RLA<cost>; }
+			else if constexpr (y == 3) { return RRA<cost>; }
+			else if constexpr (y == 4) { return DAA<cost>; }
+			else if constexpr (y == 5) { return CPL<cost>; }
+			else if constexpr (y == 6) { return SCF<cost>; }
+			else { return CCF<cost>; }
+		}
+	}
+	else if constexpr (z == 0)
+	{
+		if constexpr (y == 4) { return LDH<$(a8), A, cost>; }
+		else if constexpr (y == 5) { return ADD<SP, r8, cost>; }
+		else if constexpr (y == 6) { return LDH<A, $(a8), cost>; }
+		else if constexpr (y == 7) { return LD_SPr8<HL, cost>; }
+		else { return RET<CC<y>, taken, cost>; }
+	}
+	else if constexpr (z == 1)
+	{
+		if constexpr (q == 0) { return POP<RP2<p>, cost>; }
+		else if constexpr (p == 0) { return RET<cost>; }
+		else if constexpr (p == 1) { return RETI<cost>; }
+		else if constexpr (p == 2) { return JP<HL, cost>; }
+		else { return LD<SP, HL, cost>; }
+	}
+	else if constexpr (z == 2)
+	{
+		if constexpr (y == 4) { return LD<$(C), A, cost>; }
+		else if constexpr (y == 5) { return LD<$(a16), A, cost>; }
+		else if constexpr (y == 6) { return LD<A, $(C), cost>; }
+		else if constexpr (y == 7) { return LD<A, $(a16), cost>; }
+		else { return JP<CC<y>, a16, taken, cost>; }
+	}
+	else if constexpr (z == 3)
+	{
+		if constexpr (y == 0) { return JP<a16, cost>; }
+		else if constexpr (y == 1) { return PREFIX_CB; }
+		else if constexpr (y == 6) { return DI<cost>; }
+		else { return EI<cost>; }
+	}
+	else if constexpr (z == 4) { return CALL<CC<y>, a16, taken, cost>; }
+	else if constexpr (z == 5)
+	{
+		if constexpr (q == 0) { return PUSH<RP2<p>, cost>; }
+		else { return CALL<a16, cost>; }
+	}
+	else if constexpr (z == 6) { return Alu<y, d8, cost>(); }
+	else { return RST<u16(y * 8), cost>; }
+}
+
+template <u8 OPCODE>
+constexpr operation ExtendedOperation()
+{
+	constexpr int x = OPCODE >> 6;
+	constexpr int y = (OPCODE >> 3) & 7;
+	constexpr int z = OPCODE & 7;
+	constexpr std::size_t cost = Opcodes::DecodeExtended(OPCODE).cycles;
+
+	if constexpr (x == 0) { return Rotate<y, R8<z>, cost>(); }
+	else if constexpr (x == 1) { return BIT<y, R8<z>, cost>; }
+	else if constexpr (x == 2) { return RES<y, R8<z>, cost>; }
+	else { return SET<y, R8<z>, cost>; }
+}
+
+template <std::size_t... OPCODES>
+constexpr std::array<operation, 256> MakeOperations(std::index_sequence<OPCODES...>)
+{
+	return {{ Operation<u8(OPCODES)>()... }};
+}
+
+template <std::size_t... OPCODES>
+constexpr std::array<operation, 256> MakeExtendedOperations(std::index_sequence<OPCODES...>)
+{
+	return {{ ExtendedOperation<u8(OPCODES)>()... }};
+}
@@ -0,0 +1,42 @@
+#include "parallel.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+unsigned Parallel::DefaultThreadCount()
+{
+	unsigned threads = std::thread::hardware_concurrency();
+	return threads ? threads : 1;
+}
+
+void Parallel::For(std::size_t count, const std::function<void(std::size_t)>& job, unsigned threads)
+{
+	if (threads == 0)
+	{
+		threads = DefaultThreadCount();
+	}
+	if (threads > count)
+	{
+		threads = (unsigned)count;
+	}
+
+	std::atomic<std::size_t> next_index(0);
+	auto worker = [&]()
+	{
+		for (std::size_t i = next_index++; i < count; i = next_index++)
+		{
+			job(i);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 0; i < threads; ++i)
+	{
+		workers.emplace_back(worker);
+	}
+	for (auto& thread : workers)
+	{
+		thread.join();
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace Parallel
+{
+	// Runs job(0) .. job(count - 1) on a pool of worker threads, each pulling the next index until none remain.
+	// Every worker owns its own thread_local machine. threads == 0 uses one worker per hardware thread.
+	void For(std::size_t count, const std::function<void(std::size_t)>& job, unsigned threads = 0);
+
+	unsigned DefaultThreadCount();
+}
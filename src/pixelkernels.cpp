@@ -0,0 +1,217 @@
+#include "pixelkernels.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GBEMU_PIXELKERNELS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define GBEMU_TARGET(isa)
+#else
+#include <immintrin.h>
+#define GBEMU_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace PixelKernels
+{
+	static void DecodeTileScalar(const u8* data, u8* indices)
+	{
+		for (int row = 0; row < 8; ++row)
+		{
+			const u8 low_bits = data[row * 2];
+			const u8 high_bits = data[row * 2 + 1];
+			for (int x = 0; x < 8; ++x)
+			{
+				*indices++ = (((high_bits >> (7 - x)) & 0x01) << 1) | ((low_bits >> (7 - x)) & 0x01);
+			}
+		}
+	}
+
+	static void MapPaletteScalar(const u8* indices, int count, const u32* colors, u8* pixels)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			memcpy(pixels + i * 4, &colors[indices[i] & 0x03], 4);
+		}
+	}
+
+#ifdef GBEMU_PIXELKERNELS_X86
+	// Control for pshufb picking the low (offset 0) or high (offset 1) bitplane byte of rows row and row + 1, each
+	// repeated for the 8 pixels
+	GBEMU_TARGET("ssse3")
+	static __m128i RowPairShuffle(int row, int offset)
+	{
+		const char a = char(row * 2 + offset);
+		const char b = char(row * 2 + 2 + offset);
+		return _mm_setr_epi8(a, a, a, a, a, a, a, a, b, b, b, b, b, b, b, b);
+	}
+
+	GBEMU_TARGET("ssse3")
+	static void DecodeTileSSSE3(const u8* data, u8* indices)
+	{
+		// One bit per pixel, leftmost pixel in the top bit
+		const __m128i bits = _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+		const __m128i one = _mm_set1_epi8(1);
+		const __m128i tile = _mm_loadu_si128((const __m128i*)data);
+		for (int row = 0; row < 8; row += 2)
+		{
+			const __m128i low = _mm_shuffle_epi8(tile, RowPairShuffle(row, 0));
+			const __m128i high = _mm_shuffle_epi8(tile, RowPairShuffle(row, 1));
+			const __m128i low_set = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(low, bits), bits), one);
+			const __m128i high_set = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(high, bits), bits), one);
+			_mm_storeu_si128((__m128i*)(indices + row * 8), _mm_or_si128(low_set, _mm_add_epi8(high_set, high_set)));
+		}
+	}
+
+	GBEMU_TARGET("ssse3")
+	static void MapPaletteSSSE3(const u8* indices, int count, const u32* colors, u8* pixels)
+	{
+		// A byte table per channel, each looked up 16 pixels at a time and then interleaved back into pixels
+		char channels[4][16] = {};
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				channels[channel][i] = char(colors[i] >> (channel * 8));
+			}
+		}
+		const __m128i r_table = _mm_loadu_si128((const __m128i*)channels[0]);
+		const __m128i g_table = _mm_loadu_si128((const __m128i*)channels[1]);
+		const __m128i b_table = _mm_loadu_si128((const __m128i*)channels[2]);
+		const __m128i a_table = _mm_loadu_si128((const __m128i*)channels[3]);
+		const __m128i index_mask = _mm_set1_epi8(0x03);
+
+		int i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			const __m128i index = _mm_and_si128(_mm_loadu_si128((const __m128i*)(indices + i)), index_mask);
+			const __m128i r = _mm_shuffle_epi8(r_table, index);
+			const __m128i g = _mm_shuffle_epi8(g_table, index);
+			const __m128i b = _mm_shuffle_epi8(b_table, index);
+			const __m128i a = _mm_shuffle_epi8(a_table, index);
+			const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+			const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+			const __m128i ba_lo = _mm_unpacklo_epi8(b, a);
+			const __m128i ba_hi = _mm_unpackhi_epi8(b, a);
+			u8* out = pixels + i * 4;
+			_mm_storeu_si128((__m128i*)(out + 0), _mm_unpacklo_epi16(rg_lo, ba_lo));
+			_mm_storeu_si128((__m128i*)(out + 16), _mm_unpackhi_epi16(rg_lo, ba_lo));
+			_mm_storeu_si128((__m128i*)(out + 32), _mm_unpacklo_epi16(rg_hi, ba_hi));
+			_mm_storeu_si128((__m128i*)(out + 48), _mm_unpackhi_epi16(rg_hi, ba_hi));
+		}
+		MapPaletteScalar(indices + i, count - i, colors, pixels + i * 4);
+	}
+
+	GBEMU_TARGET("avx2")
+	static void DecodeTileAVX2(const u8* data, u8* indices)
+	{
+		// Both lanes hold the whole tile, so the in lane byte shuffle can reach any row
+		const __m256i bits = _mm256_setr_epi8(
+			-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1,
+			-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+		const __m256i one = _mm256_set1_epi8(1);
+		const __m256i tile = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)data));
+		for (int row = 0; row < 8; row += 4)
+		{
+			const __m256i low_shuffle = _mm256_setr_m128i(RowPairShuffle(row, 0), RowPairShuffle(row + 2, 0));
+			const __m256i high_shuffle = _mm256_setr_m128i(RowPairShuffle(row, 1), RowPairShuffle(row + 2, 1));
+			const __m256i low = _mm256_shuffle_epi8(tile, low_shuffle);
+			const __m256i high = _mm256_shuffle_epi8(tile, high_shuffle);
+			const __m256i low_set = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(low, bits), bits), one);
+			const __m256i high_set = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(high, bits), bits), one);
+			_mm256_storeu_si256((__m256i*)(indices + row * 8), _mm256_or_si256(low_set, _mm256_add_epi8(high_set, high_set)));
+		}
+	}
+
+	GBEMU_TARGET("avx2")
+	static void MapPaletteAVX2(const u8* indices, int count, const u32* colors, u8* pixels)
+	{
+		// Whole pixels looked up 8 at a time, the index widened to a dword selects the color with a permute
+		const __m256i table = _mm256_setr_epi32(int(colors[0]), int(colors[1]), int(colors[2]), int(colors[3]), 0, 0, 0, 0);
+		const __m256i index_mask = _mm256_set1_epi32(0x03);
+
+		int i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			const __m128i index = _mm_loadu_si128((const __m128i*)(indices + i));
+			const __m256i index_lo = _mm256_and_si256(_mm256_cvtepu8_epi32(index), index_mask);
+			const __m256i index_hi = _mm256_and_si256(_mm256_cvtepu8_epi32(_mm_srli_si128(index, 8)), index_mask);
+			_mm256_storeu_si256((__m256i*)(pixels + i * 4), _mm256_permutevar8x32_epi32(table, index_lo));
+			_mm256_storeu_si256((__m256i*)(pixels + i * 4 + 32), _mm256_permutevar8x32_epi32(table, index_hi));
+		}
+		MapPaletteScalar(indices + i, count - i, colors, pixels + i * 4);
+	}
+#endif
+
+	ISA GetSupportedISA()
+	{
+#ifdef GBEMU_PIXELKERNELS_X86
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int max_leaf = info[0];
+		__cpuid(info, 1);
+		const bool ssse3 = info[2] & (1 << 9);
+		// AVX2 also needs the OS to save the upper halves of the registers
+		const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x06) == 0x06;
+		bool avx2 = false;
+		if (max_leaf >= 7 && os_saves_ymm)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = info[1] & (1 << 5);
+		}
+#else
+		__builtin_cpu_init();
+		const bool ssse3 = __builtin_cpu_supports("ssse3");
+		const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+		if (avx2)
+		{
+			return ISA::AVX2;
+		}
+		if (ssse3)
+		{
+			return ISA::SSSE3;
+		}
+#endif
+		return ISA::SCALAR;
+	}
+
+	static ISA selected = ISA::SCALAR;
+
+	void Select(ISA isa)
+	{
+		const ISA supported = GetSupportedISA();
+		selected = (int)isa < (int)supported ? isa : supported;
+		switch (selected)
+		{
+#ifdef GBEMU_PIXELKERNELS_X86
+		case ISA::AVX2:
+			DecodeTile = DecodeTileAVX2;
+			MapPalette = MapPaletteAVX2;
+			break;
+		case ISA::SSSE3:
+			DecodeTile = DecodeTileSSSE3;
+			MapPalette = MapPaletteSSSE3;
+			break;
+#endif
+		default:
+			DecodeTile = DecodeTileScalar;
+			MapPalette = MapPaletteScalar;
+			break;
+		}
+	}
+
+	ISA GetSelectedISA()
+	{
+		return selected;
+	}
+
+	DecodeTileFunction DecodeTile = DecodeTileScalar;
+	MapPaletteFunction MapPalette = MapPaletteScalar;
+
+	// Picks the best kernels before main runs
+	static const bool selected_at_startup = (Select(ISA::AVX2), true);
+}
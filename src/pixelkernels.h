@@ -0,0 +1,32 @@
+#pragma once
+#include "types.h"
+
+// The inner loops of rendering: decoding 2bpp tile data to color indices and mapping color indices to ABGR8888
+// pixels through a palette's color table. Each has SSSE3 and AVX2 versions, picked once at startup from what
+// the host CPU supports, and a scalar fallback for everything else.
+namespace PixelKernels
+{
+	enum class ISA
+	{
+		SCALAR,
+		SSSE3,
+		AVX2,
+	};
+
+	// Decodes the 16 bytes of a tile (8 rows of low then high bitplane) to 64 color indices, leftmost pixel first
+	typedef void(*DecodeTileFunction)(const u8* data, u8* indices);
+
+	// Writes count pixels for count color indices, colors holds the ABGR8888 value for each of the 4 indices
+	typedef void(*MapPaletteFunction)(const u8* indices, int count, const u32* colors, u8* pixels);
+
+	// Process wide, best supported by default
+	extern DecodeTileFunction DecodeTile;
+	extern MapPaletteFunction MapPalette;
+
+	// The best the host supports
+	ISA GetSupportedISA();
+
+	// Switches to the kernels for isa, or the best supported below it. Set before running.
+	void Select(ISA isa);
+	ISA GetSelectedISA();
+}
@@ -1,12 +1,21 @@
 #include "constants.h"
 #include "cpu.h"
-#include "main.h"
 #include "bus.h"
+#include "instrument.h"
+#include "interrupts.h"
+#include "memory.h"
+#include "pixelkernels.h"
 #include "ppu.h"
+#include "tilecache.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <cassert>
-#include <queue>
+#include <chrono>
+#include <cstring>
+#include <vector>
 
 namespace Bus
 {
@@ -39,6 +48,7 @@ enum class FETCH_MODE
 {
 	DISABLED,
 	BACKGROUND,
+	WINDOW,
 	SPRITE,
 };
 
@@ -62,6 +72,16 @@ struct FifoPixel
 	u8 color;
 };
 
+// Bits per pixel in the fifo attribute registers: the palette, and whether the background is drawn over sprites
+const int FIFO_ATTRIBUTE_PALETTE_BITS = 0x03;
+const int FIFO_ATTRIBUTE_PRIORITY_BIT = 0x04;
+
+// OAM attribute byte
+const u8 SPRITE_FLAG_BACKGROUND_PRIORITY = 0x80;
+const u8 SPRITE_FLAG_Y_FLIP = 0x40;
+const u8 SPRITE_FLAG_X_FLIP = 0x20;
+const u8 SPRITE_FLAG_PALETTE = 0x10;
+
 const int DISPLAY_WIDTH = 160;
 const int DISPLAY_HEIGHT = 144;
 const int PIXEL_TRANSFER_START_CYCLE = 20 * 4;
@@ -72,64 +92,226 @@ const int BACKGROUND_MAP_NUM_TILES_XY = 32;
 const int BACKGROUND_MAP_TILE_NUM_PIXELS_XY = 8;
 const int BACKGROUND_MAP_NUM_PIXELS_XY = BACKGROUND_MAP_NUM_TILES_XY * BACKGROUND_MAP_TILE_NUM_PIXELS_XY;
 const int TILE_SIZE_BYTES = 16;
+const int OAM_SPRITE_COUNT = 40;
+const int OAM_SPRITE_SIZE_BYTES = 4;
+const int MAX_SPRITES_PER_LINE = 10;
+const int SPRITE_FETCH_CYCLES = 6;
+const int WINDOW_X_OFFSET = 7;
+const int WINDOW_X_HIDDEN = DISPLAY_WIDTH + WINDOW_X_OFFSET; // WX from here on puts the window off screen
+
+static thread_local PPU_STAGE ppu_stage = PPU_STAGE::DISABLED;
+static thread_local int current_h_cycle = -1;
+// Steps PPU::Advance may still skip without looking, 0 when unknown. Any step, LCDC write or state load drops it.
+static thread_local u32 idle_cycles = 0;
+
+static thread_local FIFO_MODE fifo_mode = FIFO_MODE::DISABLED;
+// 16 pixel shift registers with the next pixel out in the top bits: 2 bits of color and 4 bits of attributes each
+static thread_local u32 fifo_colors = 0;
+static thread_local u64 fifo_attributes = 0;
+static thread_local u8 fifo_size = 0;
+static thread_local u8 fifo_pixels_written_out = 0;
+static thread_local u8 fifo_pixels_to_discard = 0;
+
+// Sprite pixels waiting to be mixed over the background as it leaves the fifo, color 0 where there are none. Kept
+// apart so the window restarting the background fifo doesn't lose them.
+static thread_local u16 sprite_fifo_colors = 0;
+static thread_local u32 sprite_fifo_attributes = 0;
+
+// Bit n is set for OAM sprite n on every line its Y covers, kept up to date by OAM and LCDC writes
+static thread_local u64 line_sprite_masks[DISPLAY_HEIGHT];
+
+// The current line's OAM scan result in drawing priority order: by X, then OAM index
+static thread_local PPU::LineSprite line_sprites[MAX_SPRITES_PER_LINE];
+static thread_local u8 line_sprite_count = 0;
+static thread_local u8 line_sprites_fetched = 0;
+static thread_local int sprite_stall_cycles = 0;
+
+// The window shows once LY has matched WY this frame, and only advances its own line counter on lines it is drawn on
+static thread_local bool window_y_reached = false;
+static thread_local u8 window_line = 0;
+static thread_local u8 line_window_x = WINDOW_X_HIDDEN; // WX latched for the current line, WINDOW_X_HIDDEN for none
+
+// Scanline rendering, see PPU::FIDELITY
+static thread_local bool scanline_line = false;
+static thread_local int scanline_hblank_cycle = 0;
+static thread_local std::bitset<DISPLAY_HEIGHT> fifo_lines;		// Lines drawn through the fifo this frame
+static thread_local std::bitset<DISPLAY_HEIGHT> fifo_lines_next;	// Lines that had registers written during pixel transfer
+
+PPU::FIDELITY PPU::fidelity = PPU::FIDELITY::DOTS;
+
+// Frame skipping, see PPU::FRAMESKIP
+static thread_local bool render_frame = true;
+static thread_local bool frame_requested = false;
+static thread_local std::chrono::steady_clock::time_point adaptive_deadline;
+static thread_local int adaptive_frames_skipped = 0;
+
+const int MAX_ADAPTIVE_FRAMES_SKIPPED = 4;
+const std::chrono::nanoseconds FRAME_DURATION(u64(NUM_LINES_TOTAL) * NUM_LINE_CYCLES * 1000000000ULL / 4194304);
+
+PPU::FRAMESKIP PPU::frameSkip = PPU::FRAMESKIP::NONE;
+int PPU::frameSkipInterval = 1;
 
-static PPU_STAGE ppu_stage = PPU_STAGE::DISABLED;
-static int current_h_cycle = -1;
+static thread_local FETCH_MODE fetch_mode = FETCH_MODE::DISABLED;
+static thread_local FETCH_STAGE fetch_stage = (FETCH_STAGE)0;
+static thread_local u16 fetch_source_address;
+static thread_local u8 fetch_tile_number;
+static thread_local u8 fetch_tile_data_low_bits;
+static thread_local u8 fetch_tile_data_high_bits;
+static thread_local u8 fetch_fetched_bg_tiles = 0;
 
-static FIFO_MODE fifo_mode = FIFO_MODE::DISABLED;
-static std::queue<FifoPixel> fifo_queue;
-static u8 fifo_pixels_written_out = 0;
-static u8 fifo_pixels_to_discard = 0;
+// ABGR8888 color for each of the 4 color indices, per PALETTE_TYPE, rebuilt when BGP/OBP0/OBP1 are written
+static thread_local u32 palette_colors[3][4];
 
-static FETCH_MODE fetch_mode = FETCH_MODE::DISABLED;
-static FETCH_STAGE fetch_stage = (FETCH_STAGE)0;
-static u16 fetch_source_address;
-static u8 fetch_tile_number;
-static u8 fetch_tile_data_low_bits;
-static u8 fetch_tile_data_high_bits;
-static u8 fetch_fetched_bg_tiles = 0;
+const PPU::ColorScheme PPU::GREYSCALE = { { 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555, 0xFF000000 } };
+const PPU::ColorScheme PPU::DMG_GREEN = { { 0xFF0FBC9B, 0xFF0FAC8B, 0xFF306230, 0xFF0F380F } };
+PPU::ColorScheme PPU::colorScheme = PPU::GREYSCALE;
 
-static SDL_Renderer* sdl_renderer = nullptr;
-static SDL_Texture* sdl_texture = nullptr;
-static u8* sdl_pixels = nullptr;
-static u8* sdl_pixels_write = nullptr;
-static bool sdl_texture_locked = false;
-static int current_frame_index = 0;
+// Frames are drawn here, in plain memory the core owns, and handed to the presenter (if any) once complete. Aligned
+// to a cache line so every row the kernels write starts on one.
+alignas(64) static thread_local u8 frame_buffer[total_gb_display_bytes];
+static thread_local u8* frame_pixels_write = nullptr;
+static thread_local PPU::Presenter presenter = nullptr;
+static thread_local int current_frame_index = 0;
 
-void PresentBackBuffer()
+void PresentFrame()
 {
-	if (sdl_texture_locked)
+	INSTRUMENT_SCOPE(PRESENT);
+
+	if (presenter)
 	{
-		SDL_UnlockTexture(sdl_texture);
-		sdl_texture_locked = false;
+		presenter(frame_buffer);
 	}
-	SDL_RenderCopy(sdl_renderer, sdl_texture, nullptr, nullptr);
-	SDL_RenderPresent(sdl_renderer);
 }
 
 void ClearToWhite()
 {	
-	if (!sdl_texture_locked)
+	// The lightest shade, which is white unless a color scheme says otherwise
+	u32* pixels = (u32*)frame_buffer;
+	for (int i = 0; i < gb_width * gb_height; ++i)
+	{
+		pixels[i] = PPU::colorScheme.shades[0];
+	}
+
+	PresentFrame();
+}
+
+void UpdatePaletteColors(PALETTE_TYPE palette)
+{
+	const u8 palette_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_BG_PALETTE + (u16)palette);
+	for (int color = 0; color < 4; ++color)
 	{
-		int unused_pitch;
-		SDL_LockTexture(sdl_texture, nullptr, (void**)&sdl_pixels, &unused_pitch);
-		sdl_texture_locked = true;
+		palette_colors[(int)palette][color] = PPU::colorScheme.shades[(palette_reg >> color * 2) & 0x03];
 	}
-	
-	memset((void*)sdl_pixels, 255, total_gb_display_bytes);
+}
 
-	PresentBackBuffer();
+int GetSpriteHeight()
+{
+	u8 lcdc_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_LCD_CONTROL);
+	return lcdc_reg & (u8)LCD_CONTROL_FLAGS::SPRITE_SIZE ? 16 : 8;
+}
+
+// Adds (or removes) sprite to the masks of the lines a sprite at y covers
+void SetSpriteLines(int sprite, u8 y, bool set)
+{
+	// OAM Y is the sprite's top line plus 16
+	const int top = y - 16;
+	const int bottom = top + GetSpriteHeight();
+	for (int line = top < 0 ? 0 : top; line < bottom && line < DISPLAY_HEIGHT; ++line)
+	{
+		if (set)
+		{
+			line_sprite_masks[line] |= 1ULL << sprite;
+		}
+		else
+		{
+			line_sprite_masks[line] &= ~(1ULL << sprite);
+		}
+	}
+}
+
+void RebuildSpriteLines()
+{
+	memset(line_sprite_masks, 0, sizeof(line_sprite_masks));
+	for (int sprite = 0; sprite < OAM_SPRITE_COUNT; ++sprite)
+	{
+		SetSpriteLines(sprite, Memory::LoadU8((u16)AddressRegion::OAM_START + sprite * OAM_SPRITE_SIZE_BYTES), true);
+	}
 }
 
 void PPU::Init()
 {
-	sdl_renderer = SDL_CreateRenderer(g_window, -1, SDL_RENDERER_PRESENTVSYNC);
-	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, 0);
-	sdl_texture = SDL_CreateTexture(sdl_renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, 160, 144);
+	idle_cycles = 0;
+	RebuildSpriteLines();
+	line_sprite_count = 0;
+	sprite_stall_cycles = 0;
+
+	render_frame = true;
+	frame_requested = false;
+	adaptive_deadline = std::chrono::steady_clock::now();
+	adaptive_frames_skipped = 0;
+
+	UpdatePaletteColors(PALETTE_TYPE::BG);
+	UpdatePaletteColors(PALETTE_TYPE::S0);
+	UpdatePaletteColors(PALETTE_TYPE::S1);
 
 	ClearToWhite();
 }
 
+void ClearFifo()
+{
+	fifo_colors = 0;
+	fifo_attributes = 0;
+	fifo_size = 0;
+}
+
+void ClearSpriteFifo()
+{
+	sprite_fifo_colors = 0;
+	sprite_fifo_attributes = 0;
+}
+
+// Spreads the 8 bits of a tile row bitplane out to every other bit, leftmost pixel at the top
+u16 SpreadBitplane(u8 bits)
+{
+	u16 spread = bits;
+	spread = (spread | (spread << 4)) & 0x0F0F;
+	spread = (spread | (spread << 2)) & 0x3333;
+	spread = (spread | (spread << 1)) & 0x5555;
+	return spread;
+}
+
+// Appends the 8 pixels of a tile row behind the ones already in the fifo
+void PushFifo(u8 low_bits, u8 high_bits, u8 attributes)
+{
+	assert(fifo_size <= 8);
+	const u16 colors = SpreadBitplane(low_bits) | (SpreadBitplane(high_bits) << 1);
+	fifo_colors |= u32(colors) << (16 - 2 * fifo_size);
+	fifo_attributes |= (0x11111111ULL * attributes) << (32 - 4 * fifo_size);
+	fifo_size += 8;
+}
+
+FifoPixel PopFifo()
+{
+	assert(fifo_size > 0);
+	FifoPixel fifo_pixel;
+	fifo_pixel.color = u8(fifo_colors >> 30);
+	fifo_pixel.palette = PALETTE_TYPE((fifo_attributes >> 60) & FIFO_ATTRIBUTE_PALETTE_BITS);
+	fifo_colors <<= 2;
+	fifo_attributes <<= 4;
+	fifo_size--;
+
+	const u8 sprite_color = u8(sprite_fifo_colors >> 14);
+	const u8 sprite_attributes = u8(sprite_fifo_attributes >> 28);
+	sprite_fifo_colors <<= 2;
+	sprite_fifo_attributes <<= 4;
+	if (sprite_color != 0 && (!(sprite_attributes & FIFO_ATTRIBUTE_PRIORITY_BIT) || fifo_pixel.color == 0))
+	{
+		fifo_pixel.color = sprite_color;
+		fifo_pixel.palette = PALETTE_TYPE(sprite_attributes & FIFO_ATTRIBUTE_PALETTE_BITS);
+	}
+	return fifo_pixel;
+}
+
 void Disable()
 {
 	current_h_cycle = -1;
@@ -137,29 +319,37 @@ void Disable()
 
 	fifo_mode = FIFO_MODE::DISABLED;
 	fetch_mode = FETCH_MODE::DISABLED;
-	fifo_queue = {};
+	ClearFifo();
+	ClearSpriteFifo();
+	line_sprite_count = 0;
+	sprite_stall_cycles = 0;
+	window_y_reached = false;
+	window_line = 0;
+	line_window_x = WINDOW_X_HIDDEN;
+	scanline_line = false;
+	fifo_lines.reset();
+	fifo_lines_next.reset();
 
 	ClearToWhite();
 }
 
+// LY as the PPU keeps it. CPU reads go through the bus, which may show something else, see Doctor::stubLY.
+static u8 GetLY()
+{
+	return Memory::LoadU8((u16)SpecialRegister::VIDEO_CURRENT_SCANLINE);
+}
+
 int GetCurrentLineIdx()
 {
-	u8 scanline_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_CURRENT_SCANLINE);
+	u8 scanline_reg = GetLY();
 	u8 scroll_y = Bus::LoadU8((u16)SpecialRegister::VIDEO_SCROLLY);
 	return (scanline_reg + scroll_y) % BACKGROUND_MAP_NUM_PIXELS_XY;
 }
 
 void WritePixel(FifoPixel fifo_pixel)
 {
-	u16 palette_address = (u16)SpecialRegister::VIDEO_BG_PALETTE + (u16)fifo_pixel.palette;
-	u8 palette = Bus::LoadU8(palette_address);
-	u8 color = (palette >> fifo_pixel.color * 2) & 0x03;
-
-	u8 greyscale = 255 - (85 * color);
-	*sdl_pixels_write++ = greyscale;
-	*sdl_pixels_write++ = greyscale;
-	*sdl_pixels_write++ = greyscale;
-	*sdl_pixels_write++ = 255;
+	memcpy(frame_pixels_write, &palette_colors[(int)fifo_pixel.palette][fifo_pixel.color], 4);
+	frame_pixels_write += 4;
 
 #if 0
 	// Crosshair rendering, useful for isolating problem pixels
@@ -168,23 +358,15 @@ void WritePixel(FifoPixel fifo_pixel)
 	const int y_coord = 71;
 	if (GetCurrentLineIdx() == y_coord || fifo_pixels_written_out == x_coord)
 	{
-		*(sdl_pixels_write - 4) = 255;
-		*(sdl_pixels_write - 3) = 0;
-		*(sdl_pixels_write - 2) = 0;
+		*(frame_pixels_write - 4) = 255;
+		*(frame_pixels_write - 3) = 0;
+		*(frame_pixels_write - 2) = 0;
 	}
 #endif
 
 #if 0
 	// Immediately present every pixel (useful when stepping)
-	auto write_offset = sdl_pixels_write - sdl_pixels;
-	PresentBackBuffer();
-	if (!sdl_texture_locked)
-	{
-		int unused_pitch;
-		SDL_LockTexture(sdl_texture, nullptr, (void**)&sdl_pixels, &unused_pitch);
-		sdl_texture_locked = true;
-	}
-	sdl_pixels_write = sdl_pixels + write_offset;
+	PresentFrame();
 #endif // 0
  }
 
@@ -193,6 +375,10 @@ void BeginHBlank()
 	ppu_stage = PPU_STAGE::HBLANK;
 	fifo_mode = FIFO_MODE::DISABLED;
 	fetch_mode = FETCH_MODE::DISABLED;
+	if (line_window_x != WINDOW_X_HIDDEN)
+	{
+		window_line++;
+	}
 
 	// trigger interrupt
 	{
@@ -203,14 +389,17 @@ void BeginHBlank()
 		statRegister |= (u8)LCD_STATUS_FLAGS::INTERRUPT_MODE_HBLANK; // Set the HBlank interrupt bit
 
 		Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_LCD_STATUS, statRegister);
-		CPU::RaiseInterrupt(INTERRUPT_FLAGS::LCD_STAT);
+		Interrupts::Raise(INTERRUPT_FLAGS::LCD_STAT);
 	}
 }
 
 void BeginVBlank()
 {
 	ppu_stage = PPU_STAGE::VBLANK;
-	PresentBackBuffer();
+	if (render_frame)
+	{
+		PresentFrame();
+	}
 
 	// trigger interrupt
 	{
@@ -221,10 +410,10 @@ void BeginVBlank()
 		statRegister |= (u8)LCD_STATUS_FLAGS::INTERRUPT_MODE_VBLANK; // Set the HBlank interrupt bit
 
 		Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_LCD_STATUS, statRegister);
-		CPU::RaiseInterrupt(INTERRUPT_FLAGS::VBLANK);
+		Interrupts::Raise(INTERRUPT_FLAGS::VBLANK);
 
 		// todo : Raise the LCD_STAT too??
-		//CPU::RaiseInterrupt(INTERRUPT_FLAGS::LCD_STAT);
+		//Interrupts::Raise(INTERRUPT_FLAGS::LCD_STAT);
 	}
 }
 
@@ -235,10 +424,9 @@ void StepFifo()
 		return;
 	}
 
-	if (fifo_queue.size() > 8)
+	if (fifo_size > 8)
 	{
-		auto pixel = fifo_queue.front();
-		fifo_queue.pop();
+		auto pixel = PopFifo();
 
 		if (fifo_pixels_to_discard > 0)
 		{
@@ -256,36 +444,133 @@ void StepFifo()
 	}
 }
 
+// Mixes the 8 pixels of a sprite row into the sprite fifo. Pixels an earlier sprite already has win, and transparent
+// ones are left for later sprites. Whether the background shows through is worked out as pixels leave the fifo.
+void MixSpriteIntoFifo(const PPU::LineSprite& sprite)
+{
+	const u8* row = TileCache::GetRow(sprite.rowAddress);
+	u8 attributes = u8(sprite.flags & SPRITE_FLAG_PALETTE ? PALETTE_TYPE::S1 : PALETTE_TYPE::S0);
+	if (sprite.flags & SPRITE_FLAG_BACKGROUND_PRIORITY)
+	{
+		attributes |= FIFO_ATTRIBUTE_PRIORITY_BIT;
+	}
+
+	// Sprites hanging off the left edge start part way through their row
+	const int first_column = sprite.x < 8 ? 8 - sprite.x : 0;
+	for (int column = first_column; column < 8; ++column)
+	{
+		const u8 color = row[sprite.flags & SPRITE_FLAG_X_FLIP ? 7 - column : column];
+		const int position = column - first_column;
+		const int color_shift = 14 - 2 * position;
+		if (color == 0 || ((sprite_fifo_colors >> color_shift) & 0x03))
+		{
+			continue;
+		}
+		sprite_fifo_colors |= u16(color << color_shift);
+		sprite_fifo_attributes |= u32(attributes) << (28 - 4 * position);
+	}
+}
+
+// Screen X at which the fifo stops to fetch the sprite
+int GetSpriteFetchX(const PPU::LineSprite& sprite)
+{
+	return sprite.x < 8 ? 0 : sprite.x - 8;
+}
+
+// Fetches the next sprite in line instead of shifting out a pixel when the fifo reaches it, stalling the fifo and
+// background fetcher for the sprite's penalty
+bool StepSpriteFetch()
+{
+	if (line_sprites_fetched == line_sprite_count || fifo_size <= 8 || fifo_pixels_to_discard > 0)
+	{
+		return false;
+	}
+	const PPU::LineSprite& sprite = line_sprites[line_sprites_fetched];
+	if (GetSpriteFetchX(sprite) != fifo_pixels_written_out)
+	{
+		return false;
+	}
+
+	MixSpriteIntoFifo(sprite);
+	line_sprites_fetched++;
+	sprite_stall_cycles = sprite.penalty - 1;
+	return true;
+}
+
 bool IsTilePatternTableMode1()
 {
 	u8 lcd_control_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_LCD_CONTROL);
 	return lcd_control_reg & (u8)LCD_CONTROL_FLAGS::TILE_PATTERN_TABLE_ADDR;
 }
 
-u16 GetTileAddress()
+u16 GetTileRowAddress(u8 tile_number, int line_idx)
 {
 	u16 tile_address;
 	if (IsTilePatternTableMode1())
 	{
-		auto tile_address_offset = TILE_SIZE_BYTES * fetch_tile_number;
+		auto tile_address_offset = TILE_SIZE_BYTES * tile_number;
 		tile_address = u16(AddressRegion::TILE_PATTERN_TABLE_MODE_1_ELEMENT_0) + tile_address_offset;
 	}
 	else
 	{
-		s8 signed_fetch_tile_number = static_cast<s8>(fetch_tile_number);
-		s16 tile_address_offset = fetch_tile_number * TILE_SIZE_BYTES;
+		s8 signed_tile_number = static_cast<s8>(tile_number);
+		s16 tile_address_offset = signed_tile_number * TILE_SIZE_BYTES;
 		tile_address = u16(AddressRegion::TILE_PATTERN_TABLE_MODE_0_ELEMENT_0) + tile_address_offset;
 	}
-	auto row_in_tile = GetCurrentLineIdx() % 8;
+	auto row_in_tile = line_idx % 8;
 	tile_address += row_in_tile * 2;
 	return tile_address;
 }
 
+u16 GetTileAddress()
+{
+	return GetTileRowAddress(fetch_tile_number, fetch_mode == FETCH_MODE::WINDOW ? window_line : GetCurrentLineIdx());
+}
+
+u16 GetWindowMapStartAddr()
+{
+	u8 lcdc_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_LCD_CONTROL);
+	const bool mode_1 = lcdc_reg & (u8)LCD_CONTROL_FLAGS::WINDOW_MAP_ADDR;
+	return mode_1 ? (u16)AddressRegion::BACKGROUND_TILE_MAP_MODE_1_START : (u16)AddressRegion::BACKGROUND_TILE_MAP_MODE_0_START;
+}
+
+// Screen X the window starts at. WX below 7 starts it at the left edge with its first columns cut off instead.
+int GetWindowStartX(int window_x)
+{
+	return window_x < WINDOW_X_OFFSET ? 0 : window_x - WINDOW_X_OFFSET;
+}
+
+int GetWindowPixelsToDiscard(int window_x)
+{
+	return window_x < WINDOW_X_OFFSET ? WINDOW_X_OFFSET - window_x : 0;
+}
+
+// Throws away the background in the fifo and restarts the fetcher on the window. Sprites already fetched stay.
+void BeginWindowFetch()
+{
+	ClearFifo();
+	fifo_pixels_to_discard = GetWindowPixelsToDiscard(line_window_x);
+
+	fetch_source_address = GetWindowMapStartAddr();
+	fetch_fetched_bg_tiles = 0;
+	fetch_stage = (FETCH_STAGE)0;
+	fetch_mode = FETCH_MODE::WINDOW;
+}
+
+void StepWindowStart()
+{
+	if (line_window_x != WINDOW_X_HIDDEN && fetch_mode == FETCH_MODE::BACKGROUND && fifo_pixels_written_out == GetWindowStartX(line_window_x))
+	{
+		BeginWindowFetch();
+	}
+}
+
 void StepFetch()
 {
 	switch (fetch_mode)
 	{
 	case FETCH_MODE::BACKGROUND:
+	case FETCH_MODE::WINDOW:
 	{
 		switch (fetch_stage)
 		{
@@ -301,6 +586,14 @@ void StepFetch()
 				fetch_fetched_bg_tiles = fetch_fetched_bg_tiles;
 			}
 #endif
+			if (fetch_mode == FETCH_MODE::WINDOW)
+			{
+				// The window isn't scrolled and never wraps
+				const u16 tile_number_address = fetch_source_address + (window_line / 8) * BACKGROUND_MAP_NUM_TILES_XY + fetch_fetched_bg_tiles++;
+				fetch_tile_number = Bus::LoadU8(tile_number_address);
+				break;
+			}
+
 			const u8 scroll_x = Bus::LoadU8((u16)SpecialRegister::VIDEO_SCROLLX);
 			const auto background_map_horizontal_index = (scroll_x / BACKGROUND_MAP_TILE_NUM_PIXELS_XY + fetch_fetched_bg_tiles++) % BACKGROUND_MAP_NUM_TILES_XY;
 			const auto background_map_vertical_index = GetCurrentLineIdx() / 8;
@@ -319,7 +612,7 @@ void StepFetch()
 		{
 			const s16 tile_address = GetTileAddress();
 			fetch_tile_data_high_bits = Bus::LoadU8(tile_address + 1);
-			if (fifo_queue.size() > 8)
+			if (fifo_size > 8)
 			{
 				// Wait until WRITE_TO_FIFO as we are blocked from pushing out.
 				break;
@@ -335,16 +628,8 @@ void StepFetch()
 		// Intentional fallthrough
 		case FETCH_STAGE::WRITE_TO_FIFO:
 		{
-			assert(fifo_queue.size() == 0 || fifo_queue.size() == 8);
-			for (int i = 7; i >= 0; --i)
-			{
-				FifoPixel fifo_pixel;
-				fifo_pixel.palette = PALETTE_TYPE::BG;
-
-				fifo_pixel.color = ((fetch_tile_data_high_bits >> i) & 0x01) << 1;
-				fifo_pixel.color |= ((fetch_tile_data_low_bits >> i) & 0x01);
-				fifo_queue.push(fifo_pixel);
-			}
+			assert(fifo_size == 0 || fifo_size == 8);
+			PushFifo(fetch_tile_data_low_bits, fetch_tile_data_high_bits, (u8)PALETTE_TYPE::BG);
 		}
 		break;
 		}
@@ -361,6 +646,235 @@ u16 GetBackgroundMapStartAddr()
 	return mode_1 ? (u16)AddressRegion::BACKGROUND_TILE_MAP_MODE_1_START : (u16)AddressRegion::BACKGROUND_TILE_MAP_MODE_0_START;
 }
 
+// Cycles from BeginPixelTransfer to BeginHBlank, following StepWindowStart, StepFifo and StepFetch with nothing but
+// the fifo size
+int CountPixelTransferCycles(int pixels_to_discard, int window_x)
+{
+	int fifo_size = 0;
+	int pixels_written_out = 0;
+	bool window_started = window_x == WINDOW_X_HIDDEN;
+	FETCH_STAGE stage = (FETCH_STAGE)0;
+	for (int cycles = 1;; ++cycles)
+	{
+		if (!window_started && pixels_written_out == GetWindowStartX(window_x))
+		{
+			window_started = true;
+			fifo_size = 0;
+			pixels_to_discard = GetWindowPixelsToDiscard(window_x);
+			stage = (FETCH_STAGE)0;
+		}
+
+		if (fifo_size > 8)
+		{
+			fifo_size--;
+			if (pixels_to_discard > 0)
+			{
+				pixels_to_discard--;
+			}
+			else if (++pixels_written_out == DISPLAY_WIDTH)
+			{
+				return cycles;
+			}
+		}
+
+		if (stage == FETCH_STAGE::READ_DATA_MSB && fifo_size <= 8)
+		{
+			stage = FETCH_STAGE::WRITE_TO_FIFO;
+		}
+		if (stage == FETCH_STAGE::WRITE_TO_FIFO)
+		{
+			fifo_size += 8;
+		}
+		stage = static_cast<FETCH_STAGE>((static_cast<int>(stage) + 1) % static_cast<int>(FETCH_STAGE::NUM_STAGES));
+	}
+}
+
+// Indexed by SCX % 8, then the line's WX
+static const std::array<std::array<int, WINDOW_X_HIDDEN + 1>, 8> pixel_transfer_cycles = []()
+{
+	std::array<std::array<int, WINDOW_X_HIDDEN + 1>, 8> cycles;
+	for (int i = 0; i < 8; ++i)
+	{
+		for (int window_x = 0; window_x <= WINDOW_X_HIDDEN; ++window_x)
+		{
+			cycles[i][window_x] = CountPixelTransferCycles(i, window_x);
+		}
+	}
+	return cycles;
+}();
+
+// Draws the current line's sprites over a line of background pixels with the same rules as MixSpriteIntoFifo
+void RenderScanlineSprites(const u8* background_indices, u8* pixels)
+{
+	bool claimed[DISPLAY_WIDTH] = {};
+	for (int i = 0; i < line_sprite_count; ++i)
+	{
+		const PPU::LineSprite& sprite = line_sprites[i];
+		const u8* row = TileCache::GetRow(sprite.rowAddress);
+		const u32* colors = palette_colors[(int)(sprite.flags & SPRITE_FLAG_PALETTE ? PALETTE_TYPE::S1 : PALETTE_TYPE::S0)];
+		for (int column = 0; column < 8; ++column)
+		{
+			const int x = sprite.x - 8 + column;
+			if (x < 0 || x >= DISPLAY_WIDTH)
+			{
+				continue;
+			}
+			const u8 color = row[sprite.flags & SPRITE_FLAG_X_FLIP ? 7 - column : column];
+			if (color == 0 || claimed[x])
+			{
+				continue;
+			}
+			claimed[x] = true;
+			if (!(sprite.flags & SPRITE_FLAG_BACKGROUND_PRIORITY) || background_indices[x] == 0)
+			{
+				memcpy(pixels + x * 4, &colors[color], 4);
+			}
+		}
+	}
+}
+
+// Gathers the color indices of the window's tile row from the left edge of the window
+void RenderScanlineWindow(u8* indices, int count)
+{
+	const u16 map_row_address = GetWindowMapStartAddr() + (window_line / 8) * BACKGROUND_MAP_NUM_TILES_XY;
+	for (int tile = 0; tile * BACKGROUND_MAP_TILE_NUM_PIXELS_XY < count; ++tile)
+	{
+		const u8* row = TileCache::GetRow(GetTileRowAddress(Bus::LoadU8(map_row_address + tile), window_line));
+		memcpy(&indices[tile * BACKGROUND_MAP_TILE_NUM_PIXELS_XY], row, BACKGROUND_MAP_TILE_NUM_PIXELS_XY);
+	}
+}
+
+// Draws the background and window for the current line from the registers as they are now, a whole tile row at a
+// time. The result matches the fifo as long as nothing it reads changed during pixel transfer. Tile rows come from
+// TileCache.
+void RenderScanline()
+{
+	const u8 scroll_x = Bus::LoadU8((u16)SpecialRegister::VIDEO_SCROLLX);
+	const int line_idx = GetCurrentLineIdx();
+	const u16 map_row_address = GetBackgroundMapStartAddr() + (line_idx / 8) * BACKGROUND_MAP_NUM_TILES_XY;
+	const int window_start_x = line_window_x == WINDOW_X_HIDDEN ? DISPLAY_WIDTH : GetWindowStartX(line_window_x);
+
+	// Color indices for every fetched tile, starting with the ones SCX scrolls off the left. Lines the window covers
+	// from the left edge, like status bars, fetch no background at all.
+	u8 indices[DISPLAY_WIDTH + BACKGROUND_MAP_TILE_NUM_PIXELS_XY];
+	const int pixels_to_discard = scroll_x % BACKGROUND_MAP_TILE_NUM_PIXELS_XY;
+	for (int tile = 0; tile * BACKGROUND_MAP_TILE_NUM_PIXELS_XY < pixels_to_discard + window_start_x; ++tile)
+	{
+		const int map_x = (scroll_x / BACKGROUND_MAP_TILE_NUM_PIXELS_XY + tile) % BACKGROUND_MAP_NUM_TILES_XY;
+		const u8* row = TileCache::GetRow(GetTileRowAddress(Bus::LoadU8(map_row_address + map_x), line_idx));
+		memcpy(&indices[tile * BACKGROUND_MAP_TILE_NUM_PIXELS_XY], row, BACKGROUND_MAP_TILE_NUM_PIXELS_XY);
+	}
+
+	if (window_start_x < DISPLAY_WIDTH)
+	{
+		u8 window_indices[DISPLAY_WIDTH + BACKGROUND_MAP_TILE_NUM_PIXELS_XY];
+		const int window_pixels_to_discard = GetWindowPixelsToDiscard(line_window_x);
+		const int window_width = DISPLAY_WIDTH - window_start_x;
+		RenderScanlineWindow(window_indices, window_pixels_to_discard + window_width);
+		memcpy(&indices[pixels_to_discard + window_start_x], &window_indices[window_pixels_to_discard], window_width);
+	}
+
+	PixelKernels::MapPalette(&indices[pixels_to_discard], DISPLAY_WIDTH, palette_colors[(int)PALETTE_TYPE::BG], frame_pixels_write);
+	if (line_sprite_count)
+	{
+		RenderScanlineSprites(&indices[pixels_to_discard], frame_pixels_write);
+	}
+	frame_pixels_write += DISPLAY_WIDTH * 4;
+}
+
+// Called for writes to registers the background is drawn from, and to VRAM
+void NoteRegisterWrite()
+{
+	if (ppu_stage == PPU_STAGE::PIXEL_TRANSFER)
+	{
+		const int ly_reg = GetLY();
+		fifo_lines_next.set(ly_reg);
+	}
+}
+
+// The OAM scan: the first 10 sprites in OAM order that cover the line, sorted into drawing priority order
+void ScanOAM()
+{
+	line_sprite_count = 0;
+	line_sprites_fetched = 0;
+
+	const int ly_reg = GetLY();
+	const u64 mask = line_sprite_masks[ly_reg];
+	const u8 lcdc_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_LCD_CONTROL);
+	if (!mask || !(lcdc_reg & (u8)LCD_CONTROL_FLAGS::COLOR_0_WINDOW_TRANSPARENCY))
+	{
+		return;
+	}
+
+	const int height = GetSpriteHeight();
+	for (int sprite = 0; sprite < OAM_SPRITE_COUNT && line_sprite_count < MAX_SPRITES_PER_LINE; ++sprite)
+	{
+		if (!(mask & (1ULL << sprite)))
+		{
+			continue;
+		}
+
+		const u16 oam_address = (u16)AddressRegion::OAM_START + sprite * OAM_SPRITE_SIZE_BYTES;
+		PPU::LineSprite line_sprite;
+		line_sprite.x = Memory::LoadU8(oam_address + 1);
+		line_sprite.flags = Memory::LoadU8(oam_address + 3);
+		u8 tile = Memory::LoadU8(oam_address + 2);
+		int row = ly_reg + 16 - Memory::LoadU8(oam_address);
+		if (height == 16)
+		{
+			tile &= 0xFE;
+		}
+		if (line_sprite.flags & SPRITE_FLAG_Y_FLIP)
+		{
+			row = height - 1 - row;
+		}
+		// The two tiles of a 16 line sprite are consecutive, so the row can run on into the second
+		line_sprite.rowAddress = u16(AddressRegion::TILE_PATTERN_TABLE_MODE_1_ELEMENT_0) + tile * TILE_SIZE_BYTES + row * 2;
+		line_sprite.penalty = 0;
+
+		// Insertion sort, stable so OAM order breaks ties
+		int i = line_sprite_count++;
+		for (; i > 0 && line_sprites[i - 1].x > line_sprite.x; --i)
+		{
+			line_sprites[i] = line_sprites[i - 1];
+		}
+		line_sprites[i] = line_sprite;
+	}
+}
+
+// Works out how long fetching each sprite stalls pixel transfer for, returning the total. 6 cycles for the fetch, plus
+// waiting for the background fetcher to finish the tile for the first sprite over each tile.
+int UpdateSpritePenalties(int pixels_to_discard)
+{
+	int total = 0;
+	int last_tile = -1;
+	for (int i = 0; i < line_sprite_count; ++i)
+	{
+		PPU::LineSprite& sprite = line_sprites[i];
+		if (GetSpriteFetchX(sprite) >= DISPLAY_WIDTH)
+		{
+			// Never reached
+			sprite.penalty = 0;
+			continue;
+		}
+
+		sprite.penalty = SPRITE_FETCH_CYCLES;
+		const int tile = (sprite.x + pixels_to_discard) / BACKGROUND_MAP_TILE_NUM_PIXELS_XY;
+		if (sprite.x == 0)
+		{
+			sprite.penalty += 5;
+		}
+		else if (tile != last_tile)
+		{
+			const int offset = (sprite.x + pixels_to_discard) % BACKGROUND_MAP_TILE_NUM_PIXELS_XY;
+			sprite.penalty += 5 - (offset < 5 ? offset : 5);
+		}
+		last_tile = tile;
+		total += sprite.penalty;
+	}
+	return total;
+}
+
 bool IsPpuEnabled()
 {
 	u8 lcdc_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_LCD_CONTROL);
@@ -375,13 +889,38 @@ void BeginPixelTransfer()
 
 	fifo_pixels_to_discard = scroll_x % BACKGROUND_MAP_TILE_NUM_PIXELS_XY;
 	fifo_pixels_written_out = 0;
-	fifo_queue = {};
-	fifo_mode = FIFO_MODE::ENABLED;
+	ClearFifo();
+	ClearSpriteFifo();
 
-	fetch_source_address = GetBackgroundMapStartAddr();
-	fetch_fetched_bg_tiles = 0;
-	fetch_stage = (FETCH_STAGE)0;
-	fetch_mode = FETCH_MODE::BACKGROUND;
+	const int sprite_penalties = UpdateSpritePenalties(fifo_pixels_to_discard);
+	sprite_stall_cycles = 0;
+
+	const u8 lcdc_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_LCD_CONTROL);
+	const u8 window_x = Bus::LoadU8((u16)SpecialRegister::VIDEO_WINDOW_X);
+	const bool window_visible = window_y_reached && (lcdc_reg & (u8)LCD_CONTROL_FLAGS::WINDOW_DISPLAY) && window_x < WINDOW_X_HIDDEN;
+	line_window_x = window_visible ? window_x : WINDOW_X_HIDDEN;
+
+	const int ly_reg = GetLY();
+	scanline_line = !render_frame || (PPU::fidelity == PPU::FIDELITY::SCANLINE && !fifo_lines.test(ly_reg));
+	if (scanline_line)
+	{
+		// Only the timing of the fifo is needed, the line is drawn (unless the frame is skipped) when HBlank starts
+		scanline_hblank_cycle = current_h_cycle + pixel_transfer_cycles[fifo_pixels_to_discard][line_window_x] + sprite_penalties - 1;
+	}
+	else
+	{
+		fifo_mode = FIFO_MODE::ENABLED;
+
+		fetch_source_address = GetBackgroundMapStartAddr();
+		fetch_fetched_bg_tiles = 0;
+		fetch_stage = (FETCH_STAGE)0;
+		fetch_mode = FETCH_MODE::BACKGROUND;
+		if (line_window_x != WINDOW_X_HIDDEN && GetWindowStartX(line_window_x) == 0)
+		{
+			// Window only line, skip straight past the background
+			BeginWindowFetch();
+		}
+	}
 
 	// set status register
 	{
@@ -398,6 +937,11 @@ void BeginPixelTransfer()
 void BeginOAMSearch()
 {
 	ppu_stage = PPU_STAGE::OAM_SEARCH;
+	ScanOAM();
+	if (GetLY() == Bus::LoadU8((u16)SpecialRegister::VIDEO_WINDOW_Y))
+	{
+		window_y_reached = true;
+	}
 
 	// trigger interrupt
 	{
@@ -408,24 +952,66 @@ void BeginOAMSearch()
 		statRegister |= (u8)LCD_STATUS_FLAGS::INTERRUPT_MODE_OAM;
 
 		Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_LCD_STATUS, statRegister);
-		CPU::RaiseInterrupt(INTERRUPT_FLAGS::LCD_STAT);
+		Interrupts::Raise(INTERRUPT_FLAGS::LCD_STAT);
+	}
+}
+
+bool ShouldRenderFrame()
+{
+	switch (PPU::frameSkip)
+	{
+	case PPU::FRAMESKIP::FIXED:
+		return current_frame_index % PPU::frameSkipInterval == 0;
+	case PPU::FRAMESKIP::ADAPTIVE:
+	{
+		// Skip while the host is behind real time, but still show a frame every so often
+		const auto now = std::chrono::steady_clock::now();
+		adaptive_deadline += FRAME_DURATION;
+		if (now > adaptive_deadline && adaptive_frames_skipped < MAX_ADAPTIVE_FRAMES_SKIPPED)
+		{
+			adaptive_frames_skipped++;
+			return false;
+		}
+		if (now > adaptive_deadline + FRAME_DURATION * MAX_ADAPTIVE_FRAMES_SKIPPED)
+		{
+			// Too far behind to catch up, start counting from here
+			adaptive_deadline = now;
+		}
+		adaptive_frames_skipped = 0;
+		return true;
+	}
+	case PPU::FRAMESKIP::ON_REQUEST:
+	{
+		const bool requested = frame_requested;
+		frame_requested = false;
+		return requested;
+	}
+	default:
+		return true;
 	}
 }
 
 void StartNewFrame()
 {
-	if (!sdl_texture_locked)
+	++current_frame_index;
+	render_frame = ShouldRenderFrame();
+	window_y_reached = false;
+	window_line = 0;
+	if (render_frame)
 	{
-		int unused_pitch;
-		SDL_LockTexture(sdl_texture, nullptr, (void**)&sdl_pixels, &unused_pitch);
-		sdl_texture_locked = true;
+		frame_pixels_write = frame_buffer;
 	}
-	sdl_pixels_write = sdl_pixels;
-	SDL_Log("Frame %d", ++current_frame_index);
+
+	// Registers written during pixel transfer on a line tend to be written there again next frame
+	fifo_lines = fifo_lines_next;
+	fifo_lines_next.reset();
 }
 
 void PPU::Step()
 {
+	INSTRUMENT_SCOPE(PPU);
+	idle_cycles = 0;
+
 	if (!IsPpuEnabled())
 	{
 		if (ppu_stage != PPU_STAGE::DISABLED)
@@ -437,7 +1023,7 @@ void PPU::Step()
 	}
 
 	// Update current h/v values
-	u8 ly_reg = Bus::LoadU8((u16)SpecialRegister::VIDEO_CURRENT_SCANLINE);
+	u8 ly_reg = GetLY();
 	current_h_cycle++;
 	if (current_h_cycle == NUM_LINE_CYCLES) // end of line
 	{
@@ -482,10 +1068,356 @@ void PPU::Step()
 	break;
 	case PPU_STAGE::PIXEL_TRANSFER:
 	{
-		StepFifo();
-		StepFetch();
+		if (scanline_line)
+		{
+			if (current_h_cycle == scanline_hblank_cycle)
+			{
+				if (render_frame)
+				{
+					RenderScanline();
+				}
+				BeginHBlank();
+			}
+		}
+		else if (sprite_stall_cycles > 0)
+		{
+			sprite_stall_cycles--;
+		}
+		else
+		{
+			StepWindowStart();
+			if (!StepSpriteFetch())
+			{
+				StepFifo();
+				StepFetch();
+			}
+		}
 	}
 	break;
 
 	}
+}
+
+// How many of the following steps do nothing but count the cycle, before one that starts a mode, a line or a frame,
+// or steps the fifo
+static u32 GetIdleCycles()
+{
+	if (!IsPpuEnabled())
+	{
+		// Off steps do nothing at all, apart from the first one turning the PPU off
+		return ppu_stage == PPU_STAGE::DISABLED ? ~0u : 0;
+	}
+	if (ppu_stage == PPU_STAGE::DISABLED || current_h_cycle < 0)
+	{
+		return 0;
+	}
+
+	int next_event = NUM_LINE_CYCLES;
+	const int ly_reg = GetLY();
+	if (ly_reg < VBLANK_START_LINE && current_h_cycle < PIXEL_TRANSFER_START_CYCLE)
+	{
+		next_event = PIXEL_TRANSFER_START_CYCLE;
+	}
+	else if (ppu_stage == PPU_STAGE::PIXEL_TRANSFER)
+	{
+		if (!scanline_line || current_h_cycle >= scanline_hblank_cycle)
+		{
+			return 0;
+		}
+		next_event = scanline_hblank_cycle;
+	}
+	return u32(next_event - current_h_cycle - 1);
+}
+
+void PPU::Advance(u32 cycles)
+{
+	while (cycles > 0)
+	{
+		if (idle_cycles == 0)
+		{
+			idle_cycles = GetIdleCycles();
+		}
+
+		const u32 skipped = std::min(idle_cycles, cycles);
+		if (ppu_stage != PPU_STAGE::DISABLED)
+		{
+			current_h_cycle += int(skipped);
+		}
+		idle_cycles -= skipped;
+		cycles -= skipped;
+
+		if (cycles > 0)
+		{
+			Step();
+			cycles--;
+		}
+	}
+}
+
+u32 PPU::GetCyclesWithoutVRAMReads()
+{
+	if (!IsPpuEnabled())
+	{
+		// Stays off until LCDC is written
+		return ~0u;
+	}
+	if (ppu_stage == PPU_STAGE::PIXEL_TRANSFER || ppu_stage == PPU_STAGE::DISABLED)
+	{
+		return 0;
+	}
+
+	// The step that brings current_h_cycle to PIXEL_TRANSFER_START_CYCLE already fetches
+	const int ly_reg = GetLY();
+	int lines = 0;
+	if (ly_reg >= VBLANK_START_LINE)
+	{
+		lines = NUM_LINES_TOTAL - ly_reg;
+	}
+	else if (current_h_cycle >= PIXEL_TRANSFER_START_CYCLE)
+	{
+		lines = 1;
+	}
+	return u32(lines * NUM_LINE_CYCLES + PIXEL_TRANSFER_START_CYCLE - current_h_cycle - 1);
+}
+
+u32 PPU::GetCyclesWithoutInterrupts(u8 interrupts)
+{
+	if (!IsPpuEnabled())
+	{
+		// Stays off until LCDC is written
+		return ~0u;
+	}
+	if (ppu_stage == PPU_STAGE::DISABLED || current_h_cycle < 0)
+	{
+		return 0;
+	}
+
+	// Steps before the one that starts the next line
+	const int ly_reg = GetLY();
+	const int line_rest = NUM_LINE_CYCLES - 1 - current_h_cycle;
+	u32 cycles = ~0u;
+	if (interrupts & (u8)INTERRUPT_FLAGS::VBLANK)
+	{
+		// Raised by the step that starts line 144
+		const int lines = (VBLANK_START_LINE - 1 - ly_reg + NUM_LINES_TOTAL) % NUM_LINES_TOTAL;
+		cycles = std::min(cycles, u32(lines * NUM_LINE_CYCLES + line_rest));
+	}
+	if (interrupts & (u8)INTERRUPT_FLAGS::LCD_STAT)
+	{
+		// Raised when OAM search starts a visible line and when HBlank starts
+		int steps = line_rest;
+		if (ly_reg >= VBLANK_START_LINE)
+		{
+			steps = (NUM_LINES_TOTAL - 1 - ly_reg) * NUM_LINE_CYCLES + line_rest;
+		}
+		else if (ppu_stage == PPU_STAGE::PIXEL_TRANSFER)
+		{
+			if (!scanline_line)
+			{
+				// The fifo decides when HBlank starts
+				return 0;
+			}
+			steps = scanline_hblank_cycle - current_h_cycle - 1;
+		}
+		else if (current_h_cycle < PIXEL_TRANSFER_START_CYCLE)
+		{
+			// HBlank only comes after pixel transfer, which is where this stops counting
+			steps = PIXEL_TRANSFER_START_CYCLE - current_h_cycle - 1;
+		}
+		cycles = std::min(cycles, u32(steps));
+	}
+	return cycles;
+}
+
+void PPU::SaveState(State& state)
+{
+	state.stage = (int)ppu_stage;
+	state.hCycle = current_h_cycle;
+
+	state.fifoMode = (int)fifo_mode;
+	state.fifoColors = fifo_colors;
+	state.fifoAttributes = fifo_attributes;
+	state.fifoSize = fifo_size;
+	state.fifoPixelsWrittenOut = fifo_pixels_written_out;
+	state.fifoPixelsToDiscard = fifo_pixels_to_discard;
+	state.spriteFifoColors = sprite_fifo_colors;
+	state.spriteFifoAttributes = sprite_fifo_attributes;
+
+	state.fetchMode = (int)fetch_mode;
+	state.fetchStage = (int)fetch_stage;
+	state.fetchSourceAddress = fetch_source_address;
+	state.fetchTileNumber = fetch_tile_number;
+	state.fetchTileDataLowBits = fetch_tile_data_low_bits;
+	state.fetchTileDataHighBits = fetch_tile_data_high_bits;
+	state.fetchFetchedBgTiles = fetch_fetched_bg_tiles;
+
+	memcpy(state.lineSpriteMasks, line_sprite_masks, sizeof(line_sprite_masks));
+	memcpy(state.lineSprites, line_sprites, sizeof(line_sprites));
+	state.lineSpriteCount = line_sprite_count;
+	state.lineSpritesFetched = line_sprites_fetched;
+	state.spriteStallCycles = sprite_stall_cycles;
+
+	state.windowYReached = window_y_reached;
+	state.windowLine = window_line;
+	state.lineWindowX = line_window_x;
+
+	state.renderFrame = render_frame;
+
+	state.scanlineLine = scanline_line;
+	state.scanlineHBlankCycle = scanline_hblank_cycle;
+	state.fifoLines = fifo_lines;
+	state.fifoLinesNext = fifo_lines_next;
+
+	memcpy(state.paletteColors, palette_colors, sizeof(palette_colors));
+
+	state.pixelsWriteOffset = frame_pixels_write ? int(frame_pixels_write - frame_buffer) : 0;
+}
+
+void PPU::LoadState(const State& state)
+{
+	idle_cycles = 0;
+	ppu_stage = (PPU_STAGE)state.stage;
+	current_h_cycle = state.hCycle;
+
+	fifo_mode = (FIFO_MODE)state.fifoMode;
+	fifo_colors = state.fifoColors;
+	fifo_attributes = state.fifoAttributes;
+	fifo_size = state.fifoSize;
+	fifo_pixels_written_out = state.fifoPixelsWrittenOut;
+	fifo_pixels_to_discard = state.fifoPixelsToDiscard;
+	sprite_fifo_colors = state.spriteFifoColors;
+	sprite_fifo_attributes = state.spriteFifoAttributes;
+
+	fetch_mode = (FETCH_MODE)state.fetchMode;
+	fetch_stage = (FETCH_STAGE)state.fetchStage;
+	fetch_source_address = state.fetchSourceAddress;
+	fetch_tile_number = state.fetchTileNumber;
+	fetch_tile_data_low_bits = state.fetchTileDataLowBits;
+	fetch_tile_data_high_bits = state.fetchTileDataHighBits;
+	fetch_fetched_bg_tiles = state.fetchFetchedBgTiles;
+
+	memcpy(line_sprite_masks, state.lineSpriteMasks, sizeof(line_sprite_masks));
+	memcpy(line_sprites, state.lineSprites, sizeof(line_sprites));
+	line_sprite_count = state.lineSpriteCount;
+	line_sprites_fetched = state.lineSpritesFetched;
+	sprite_stall_cycles = state.spriteStallCycles;
+
+	window_y_reached = state.windowYReached;
+	window_line = state.windowLine;
+	line_window_x = state.lineWindowX;
+
+	render_frame = state.renderFrame;
+
+	scanline_line = state.scanlineLine;
+	scanline_hblank_cycle = state.scanlineHBlankCycle;
+	fifo_lines = state.fifoLines;
+	fifo_lines_next = state.fifoLinesNext;
+
+	memcpy(palette_colors, state.paletteColors, sizeof(palette_colors));
+
+	frame_pixels_write = frame_buffer + state.pixelsWriteOffset;
+}
+
+void PPU::NotifyVRAMStore()
+{
+	NoteRegisterWrite();
+}
+
+void PPU::AttachPresenter(Presenter new_presenter)
+{
+	presenter = new_presenter;
+}
+
+const u8* PPU::GetFrameBuffer()
+{
+	return frame_buffer;
+}
+
+void PPU::RequestFrame()
+{
+	frame_requested = true;
+}
+
+void PPU::W_LCDC(u8 v)
+{
+	NoteRegisterWrite();
+	idle_cycles = 0;
+	const int sprite_height = GetSpriteHeight();
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_LCD_CONTROL, v);
+	if (GetSpriteHeight() != sprite_height)
+	{
+		RebuildSpriteLines();
+	}
+}
+
+void PPU::W_OAM(u16 address, u8 v)
+{
+	const int offset = address - (u16)AddressRegion::OAM_START;
+	if (offset % OAM_SPRITE_SIZE_BYTES == 0)
+	{
+		// Y moved, so did the lines the sprite is on
+		const int sprite = offset / OAM_SPRITE_SIZE_BYTES;
+		SetSpriteLines(sprite, Memory::LoadU8(address), false);
+		SetSpriteLines(sprite, v, true);
+	}
+	Memory::StoreU8(address, v);
+}
+
+void PPU::W_DMA(u8 v)
+{
+	// Copied in one go rather than a byte per cycle while the CPU is locked out of everything but HRAM
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_OAM_DMA, v);
+	const u16 source = u16(v) << 8;
+	for (int i = 0; i < OAM_SPRITE_COUNT * OAM_SPRITE_SIZE_BYTES; ++i)
+	{
+		W_OAM((u16)AddressRegion::OAM_START + i, Bus::LoadU8(source + i));
+	}
+}
+
+void PPU::W_WY(u8 v)
+{
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_WINDOW_Y, v);
+}
+
+void PPU::W_WX(u8 v)
+{
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_WINDOW_X, v);
+}
+
+void PPU::W_STAT(u8 v)
+{
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_LCD_STATUS, v);
+}
+
+void PPU::W_SCY(u8 v)
+{
+	NoteRegisterWrite();
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_SCROLLY, v);
+}
+
+void PPU::W_SCX(u8 v)
+{
+	NoteRegisterWrite();
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_SCROLLX, v);
+}
+
+void PPU::W_BGP(u8 v)
+{
+	NoteRegisterWrite();
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_BG_PALETTE, v);
+	UpdatePaletteColors(PALETTE_TYPE::BG);
+}
+
+void PPU::W_OBP0(u8 v)
+{
+	NoteRegisterWrite();
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_SPRITE0_PALETTE, v);
+	UpdatePaletteColors(PALETTE_TYPE::S0);
+}
+
+void PPU::W_OBP1(u8 v)
+{
+	NoteRegisterWrite();
+	Bus::StoreU8_PPU((u16)SpecialRegister::VIDEO_SPRITE1_PALETTE, v);
+	UpdatePaletteColors(PALETTE_TYPE::S1);
 }
\ No newline at end of file
@@ -1,7 +1,148 @@
 #pragma once
+#include "types.h"
+
+#include <bitset>
 
 namespace PPU
 {
+	// How the background is drawn. DOTS runs the pixel fifo and fetcher every cycle. SCANLINE draws each line in one
+	// go when HBlank starts, keeping the fifo's timing, which is exact unless registers change during pixel transfer;
+	// lines that saw such writes go through the fifo again on the next frame.
+	enum class FIDELITY
+	{
+		DOTS,
+		SCANLINE,
+	};
+
+	// Process wide, set before running
+	extern FIDELITY fidelity;
+
+	// Which frames are drawn. Skipped frames still run every mode, LY/STAT update and interrupt on the same cycle as
+	// drawn ones, but fetch no tiles, leave the frame buffer alone and present nothing. FIXED draws one frame in every
+	// frameSkipInterval, ADAPTIVE skips while the host runs slower than real time, ON_REQUEST only draws frames
+	// asked for with RequestFrame.
+	enum class FRAMESKIP
+	{
+		NONE,
+		FIXED,
+		ADAPTIVE,
+		ON_REQUEST,
+	};
+
+	// Process wide, set before running
+	extern FRAMESKIP frameSkip;
+	extern int frameSkipInterval;
+
+	// ABGR8888 colors for the four shades a palette register picks from, lightest first
+	struct ColorScheme
+	{
+		u32 shades[4];
+	};
+
+	extern const ColorScheme GREYSCALE;
+	extern const ColorScheme DMG_GREEN;
+
+	// Process wide, set before running. Folded into the per palette register color tables, so it costs nothing.
+	extern ColorScheme colorScheme;
+
+	// One of the up to 10 sprites the OAM scan finds for a line
+	struct LineSprite
+	{
+		u8 x;
+		u8 flags;
+		u16 rowAddress; // Bitplanes of the sprite's row on the line
+		int penalty; // Cycles fetching it stalls pixel transfer for
+	};
+
+	// Everything needed to resume the PPU mid-frame
+	struct State
+	{
+		int stage;
+		int hCycle;
+
+		int fifoMode;
+		u32 fifoColors;
+		u64 fifoAttributes;
+		u8 fifoSize;
+		u8 fifoPixelsWrittenOut;
+		u8 fifoPixelsToDiscard;
+		u16 spriteFifoColors;
+		u32 spriteFifoAttributes;
+
+		int fetchMode;
+		int fetchStage;
+		u16 fetchSourceAddress;
+		u8 fetchTileNumber;
+		u8 fetchTileDataLowBits;
+		u8 fetchTileDataHighBits;
+		u8 fetchFetchedBgTiles;
+
+		u64 lineSpriteMasks[144];
+		LineSprite lineSprites[10];
+		u8 lineSpriteCount;
+		u8 lineSpritesFetched;
+		int spriteStallCycles;
+
+		bool windowYReached;
+		u8 windowLine;
+		u8 lineWindowX;
+
+		bool renderFrame;
+
+		bool scanlineLine;
+		int scanlineHBlankCycle;
+		std::bitset<144> fifoLines;
+		std::bitset<144> fifoLinesNext;
+
+		u32 paletteColors[3][4];
+
+		int pixelsWriteOffset;
+	};
+
 	void Init();
 	void Step();
-}
\ No newline at end of file
+	// Same as calling Step that many times, but skips through the stretches where a step only counts the cycle: OAM
+	// search, HBlank, VBlank, the LCD being off and pixel transfer on lines drawn in one go
+	void Advance(u32 cycles);
+
+	// How many of the following steps are certain not to fetch from VRAM, for code that wants to store to it ahead
+	// of time. Counts from the start of the next pixel transfer, so it is conservative.
+	u32 GetCyclesWithoutVRAMReads();
+	// How many of the following steps are certain not to raise any of the given interrupts (INTERRUPT_FLAGS bits),
+	// for code that wants to run ahead of the PPU with interrupts enabled. Conservative where the fifo decides.
+	u32 GetCyclesWithoutInterrupts(u8 interrupts);
+
+	void SaveState(State& state);
+	void LoadState(const State& state);
+
+	// Receives each drawn frame when VBlank starts, ABGR8888 and gb_width x gb_height. The pixels are only valid for
+	// the duration of the call.
+	using Presenter = void (*)(const u8* frame);
+
+	// Frames are only handed over while the calling thread's machine has a presenter attached, so a machine without
+	// one draws into memory and nothing else. Survives Init.
+	void AttachPresenter(Presenter presenter);
+
+	// The frame being drawn, or the last one drawn once VBlank starts
+	const u8* GetFrameBuffer();
+
+	// With FRAMESKIP::ON_REQUEST, draws the next frame to start
+	void RequestFrame();
+
+	// For CPU stores to VRAM, which the scanline renderer has to treat like register writes
+	void NotifyVRAMStore();
+
+	void W_LCDC(u8 v);
+	void W_STAT(u8 v);
+	void W_SCY(u8 v);
+	void W_SCX(u8 v);
+	void W_BGP(u8 v);
+	void W_OBP0(u8 v);
+	void W_OBP1(u8 v);
+	void W_DMA(u8 v);
+	void W_WY(u8 v);
+	void W_WX(u8 v);
+
+	// OAM stores, which keep the per line sprite lists up to date
+	void W_OAM(u16 address, u8 v);
+}
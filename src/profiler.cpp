@@ -0,0 +1,295 @@
+#include "profiler.h"
+
+#include "cartridge.h"
+#include "cpu.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+thread_local bool Profiler::enabled = false;
+
+struct OpcodeSample
+{
+	u64 cycles = 0;
+	u64 count = 0;
+};
+
+// A node per unique call stack. Frames are identified by the (bank << 16 | address) of the call target.
+struct StackNode
+{
+	int parent;
+	u32 frame;
+	u64 cycles;
+	std::unordered_map<u32, int> children;
+};
+
+struct ShadowFrame
+{
+	int node;
+	u16 returnAddressSP; // where the return address was pushed, lets us unwind through stack manipulation
+};
+
+const u32 ROOT_FRAME = 0xFFFFFFFF;
+const std::size_t MAX_SHADOW_DEPTH = 1024;
+
+// Per bank tables covering the whole address space, allocated when a bank is first seen
+static thread_local std::vector<std::vector<OpcodeSample>> samples;
+static thread_local std::vector<StackNode> stack_nodes;
+static thread_local std::vector<ShadowFrame> shadow_stack;
+static thread_local int current_node = 0;
+
+// bank << 16 | address -> label, ordered so we can find the closest preceding label
+static std::map<u32, std::string> symbols;
+
+static u32 MakeKey(u16 address)
+{
+	return (u32(Cartridge::GetBank(address)) << 16) | address;
+}
+
+static int FindOrAddChild(int node, u32 frame)
+{
+	auto found = stack_nodes[node].children.find(frame);
+	if (found != stack_nodes[node].children.end())
+	{
+		return found->second;
+	}
+
+	int child = (int)stack_nodes.size();
+	stack_nodes[node].children[frame] = child;
+	stack_nodes.push_back({ node, frame, 0, {} });
+	return child;
+}
+
+static void PushFrame(u16 target)
+{
+	if (shadow_stack.size() == MAX_SHADOW_DEPTH)
+	{
+		return;
+	}
+	current_node = FindOrAddChild(current_node, MakeKey(target));
+	shadow_stack.push_back({ current_node, reg.SP });
+}
+
+static void PopFrames(u16 popped_from_sp)
+{
+	// Drop every frame whose return address lived at or below the one just popped
+	while (!shadow_stack.empty() && shadow_stack.back().returnAddressSP <= popped_from_sp)
+	{
+		shadow_stack.pop_back();
+	}
+	current_node = shadow_stack.empty() ? 0 : shadow_stack.back().node;
+}
+
+void Profiler::Enable()
+{
+	Reset();
+	enabled = true;
+}
+
+void Profiler::Reset()
+{
+	samples.clear();
+	stack_nodes.clear();
+	stack_nodes.push_back({ -1, ROOT_FRAME, 0, {} });
+	shadow_stack.clear();
+	current_node = 0;
+}
+
+void Profiler::RecordOpcode(u16 pc, u16 sp, u8 opcode, std::size_t cycles)
+{
+	u8 bank = Cartridge::GetBank(pc);
+	if (bank >= samples.size())
+	{
+		samples.resize(bank + 1);
+	}
+	if (samples[bank].empty())
+	{
+		samples[bank].resize(0x10000);
+	}
+	samples[bank][pc].cycles += cycles;
+	samples[bank][pc].count++;
+	stack_nodes[current_node].cycles += cycles;
+
+	switch (opcode)
+	{
+	case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC: // CALL
+		if (reg.SP == u16(sp - 2))
+		{
+			PushFrame(reg.PC);
+		}
+		break;
+	case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF: // RST
+		PushFrame(reg.PC);
+		break;
+	case 0xC0: case 0xC8: case 0xC9: case 0xD0: case 0xD8: case 0xD9: // RET, RETI
+		if (reg.SP == u16(sp + 2))
+		{
+			PopFrames(sp);
+		}
+		break;
+	}
+}
+
+void Profiler::RecordInterrupt(u16 vector)
+{
+	PushFrame(vector);
+}
+
+bool Profiler::LoadSymbols(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		line = line.substr(0, line.find(';'));
+
+		unsigned bank, address;
+		char label[256];
+		if (sscanf(line.c_str(), " %x:%x %255s", &bank, &address, label) == 3)
+		{
+			symbols[(bank << 16) | (address & 0xFFFF)] = label;
+		}
+	}
+	return true;
+}
+
+static std::string FormatAddress(u32 key)
+{
+	char text[16];
+	snprintf(text, sizeof(text), "%02X:%04X", key >> 16, key & 0xFFFF);
+	return text;
+}
+
+// The closest label at or before key in the same bank, or "" if there is none
+static std::string Symbolize(u32 key, bool with_offset)
+{
+	auto it = symbols.upper_bound(key);
+	if (it == symbols.begin())
+	{
+		return "";
+	}
+	--it;
+	if ((it->first >> 16) != (key >> 16))
+	{
+		return "";
+	}
+
+	if (!with_offset || it->first == key)
+	{
+		return it->second;
+	}
+	std::ostringstream text;
+	text << it->second << "+" << (key - it->first);
+	return text.str();
+}
+
+bool Profiler::WriteHotspotReport(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	struct Hotspot
+	{
+		u32 key;
+		OpcodeSample sample;
+	};
+	std::vector<Hotspot> opcodes;
+	std::unordered_map<std::string, OpcodeSample> functions;
+	u64 total_cycles = 0;
+
+	for (std::size_t bank = 0; bank < samples.size(); ++bank)
+	{
+		for (std::size_t pc = 0; pc < samples[bank].size(); ++pc)
+		{
+			const OpcodeSample& sample = samples[bank][pc];
+			if (sample.count == 0)
+			{
+				continue;
+			}
+
+			u32 key = u32(bank << 16) | u32(pc);
+			opcodes.push_back({ key, sample });
+			total_cycles += sample.cycles;
+
+			std::string function = Symbolize(key, false);
+			OpcodeSample& function_sample = functions[function.empty() ? "<unknown>" : function];
+			function_sample.cycles += sample.cycles;
+			function_sample.count += sample.count;
+		}
+	}
+
+	auto percent = [&](u64 cycles) { return total_cycles ? 100.0 * cycles / total_cycles : 0.0; };
+	char line[512];
+
+	std::vector<std::pair<std::string, OpcodeSample>> sorted_functions(functions.begin(), functions.end());
+	std::sort(sorted_functions.begin(), sorted_functions.end(), [](const auto& a, const auto& b) { return a.second.cycles > b.second.cycles; });
+	file << "Functions (" << total_cycles << " cycles total)\n";
+	file << "    cycles      %      opcodes  function\n";
+	for (const auto& function : sorted_functions)
+	{
+		snprintf(line, sizeof(line), "%10llu %6.2f %12llu  %s\n", function.second.cycles, percent(function.second.cycles), function.second.count, function.first.c_str());
+		file << line;
+	}
+
+	std::sort(opcodes.begin(), opcodes.end(), [](const Hotspot& a, const Hotspot& b) { return a.sample.cycles > b.sample.cycles; });
+	file << "\nOpcodes\n";
+	file << "    cycles      %        count  address  symbol\n";
+	for (const Hotspot& hotspot : opcodes)
+	{
+		snprintf(line, sizeof(line), "%10llu %6.2f %12llu  %s  %s\n", hotspot.sample.cycles, percent(hotspot.sample.cycles), hotspot.sample.count, FormatAddress(hotspot.key).c_str(), Symbolize(hotspot.key, true).c_str());
+		file << line;
+	}
+	return true;
+}
+
+bool Profiler::WriteCollapsedStacks(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	for (std::size_t node = 0; node < stack_nodes.size(); ++node)
+	{
+		if (stack_nodes[node].cycles == 0)
+		{
+			continue;
+		}
+
+		std::vector<std::string> frames;
+		for (int n = (int)node; n != -1; n = stack_nodes[n].parent)
+		{
+			u32 frame = stack_nodes[n].frame;
+			if (frame == ROOT_FRAME)
+			{
+				frames.push_back("root");
+			}
+			else
+			{
+				std::string name = Symbolize(frame, true);
+				frames.push_back(name.empty() ? FormatAddress(frame) : name);
+			}
+		}
+
+		for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+		{
+			file << *it << (it + 1 == frames.rend() ? " " : ";");
+		}
+		file << stack_nodes[node].cycles << "\n";
+	}
+	return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "types.h"
+
+#include <cstddef>
+#include <string>
+
+// Guest code profiler. Attributes the cycle cost of every executed opcode to its (bank, PC) and to
+// the current shadow call stack, which follows CALL/RST/RET and interrupt dispatch.
+namespace Profiler
+{
+	// Checked by the CPU before every opcode, so the profiler costs a single branch when disabled
+	extern thread_local bool enabled;
+
+	void Enable();
+	void Reset();
+
+	// pc/sp are the values before the opcode ran, reg holds the values after
+	void RecordOpcode(u16 pc, u16 sp, u8 opcode, std::size_t cycles);
+	void RecordInterrupt(u16 vector);
+
+	// RGBDS / no$gmb style "BB:AAAA label" files
+	bool LoadSymbols(const std::string& path);
+
+	// Opcodes and functions sorted by total cycles
+	bool WriteHotspotReport(const std::string& path);
+	// One "frame;frame;frame cycles" line per unique call stack, for flamegraph.pl and friends
+	bool WriteCollapsedStacks(const std::string& path);
+}
@@ -0,0 +1,128 @@
+#include "recompiled.h"
+
+#include "Bus.h"
+#include "cartridge.h"
+#include "constants.h"
+#include "emulator.h"
+#include "memory.h"
+#include "operations.h"
+
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const u16 BANK_SIZE = 0x4000;
+
+bool Recompiled::allowed = true;
+thread_local bool Recompiled::enabled = false;
+
+struct LinkedProgram
+{
+	Recompiled::Program program;
+	std::once_flag built;
+	std::vector<Recompiled::Block> blocks; // indexed by bank * BANK_SIZE + (address & 0x3FFF)
+};
+
+// Function local so registration from other translation units' static initialisers is safe
+static std::vector<LinkedProgram*>& Programs()
+{
+	static std::vector<LinkedProgram*> programs;
+	return programs;
+}
+
+static thread_local const std::vector<Recompiled::Block>* bound_blocks = nullptr;
+
+bool Recompiled::Register(const Program& program)
+{
+	LinkedProgram* linked = new LinkedProgram();
+	linked->program = program;
+	Programs().push_back(linked);
+	return true;
+}
+
+static bool Matches(const Recompiled::Program& program)
+{
+	char title[17] = {};
+	for (int i = 0; i < 16; ++i)
+	{
+		title[i] = (char)Cartridge::LoadU8(u16(0x134 + i));
+	}
+	u16 checksum = u16(Cartridge::LoadU8(0x14E) << 8 | Cartridge::LoadU8(0x14F));
+	return checksum == program.globalChecksum && strcmp(title, program.title) == 0;
+}
+
+void Recompiled::Bind()
+{
+	enabled = false;
+	bound_blocks = nullptr;
+	if (!allowed)
+	{
+		return;
+	}
+
+	for (LinkedProgram* linked : Programs())
+	{
+		if (!Matches(linked->program))
+		{
+			continue;
+		}
+
+		// Built on first use and shared by every thread running this rom
+		std::call_once(linked->built, [linked]()
+		{
+			for (std::size_t i = 0; i < linked->program.count; ++i)
+			{
+				const Entry& entry = linked->program.entries[i];
+				std::size_t index = entry.bank * std::size_t(BANK_SIZE) + (entry.address & (BANK_SIZE - 1));
+				if (linked->blocks.size() <= index)
+				{
+					linked->blocks.resize(index + 1);
+				}
+				linked->blocks[index] = entry.block;
+			}
+		});
+
+		bound_blocks = &linked->blocks;
+		enabled = true;
+		return;
+	}
+}
+
+Recompiled::Block Recompiled::Find(u16 address)
+{
+	if (address >= 0x8000)
+	{
+		return nullptr;
+	}
+	if (address < 0x0100 && !Memory::LoadU8((u16)SpecialRegister::BOOTROM_SWITCH))
+	{
+		return nullptr;
+	}
+
+	std::size_t index = Cartridge::GetBank(address) * std::size_t(BANK_SIZE) + (address & (BANK_SIZE - 1));
+	return index < bound_blocks->size() ? (*bound_blocks)[index] : nullptr;
+}
+
+bool Recompiled::Continue(std::size_t cycles, u8 bank)
+{
+	Emulator::CatchUp(cycles);
+
+	if (!Emulator::CanRunAhead())
+	{
+		return false;
+	}
+	if (bank && Cartridge::GetBank(BANK_SIZE) != bank)
+	{
+		return false;
+	}
+	if (Interrupts::enableDelay > -1 || Interrupts::disableDelay > -1)
+	{
+		return false;
+	}
+	if (Interrupts::masterEnable && Interrupts::pending)
+	{
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "types.h"
+
+#include <cstddef>
+
+// Runtime side of static recompilation. gbemu_recompile turns a rom into C++ with one function per basic block;
+// linking that file in registers the blocks, and the CPU runs them in place of interpreting whenever PC lands
+// on one. Indirect jumps, code in RAM and anything that wasn't found ahead of time still go through operations[].
+namespace Recompiled
+{
+	// Runs a basic block and returns the cost of its last instruction, like an opcode handler. Returns 0 when
+	// it stopped early at an instruction boundary, in which case the rest of the machine has already caught up.
+	typedef std::size_t(*Block)(void);
+
+	struct Entry
+	{
+		u8 bank;	// 0 for 0x0000-0x3FFF
+		u16 address;
+		Block block;
+	};
+
+	struct Program
+	{
+		const char* title;		// cartridge header 0x134-0x143
+		u16 globalChecksum;		// cartridge header 0x14E-0x14F
+		const Entry* entries;
+		std::size_t count;
+	};
+
+	// Called from the static initialisers of generated code
+	bool Register(const Program& program);
+
+	// Binds the calling thread's machine to the program matching its cartridge, if one was linked in and allowed
+	void Bind();
+	extern bool allowed;
+	// Checked by the CPU at every instruction boundary
+	extern thread_local bool enabled;
+
+	// The block starting at address in the currently mapped bank, or null
+	Block Find(u16 address);
+
+	// Called by generated code between instructions. Runs the rest of the machine past the instruction that just
+	// ran, then returns false if the block has to hand back to the CPU: an interrupt is due, IME is changing, the
+	// rom bank the block was compiled for got switched out or the frame is about to end.
+	bool Continue(std::size_t cycles, u8 bank);
+}
@@ -0,0 +1,47 @@
+#include "search.h"
+
+#include "cartridge.h"
+#include "emulator.h"
+#include "joypad.h"
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <atomic>
+#include <chrono>
+
+std::vector<int> Search::Fork(const Snapshot& parent, const std::vector<InputSequence>& children, const ScoreFunction& score, unsigned threads, Stats* stats)
+{
+	std::vector<int> scores(children.size());
+	std::atomic<u64> child_frames(0);
+
+	// Children run whatever rom the parent does, inserted or the game rom
+	const Cartridge::Rom rom = Cartridge::GetInserted();
+
+	auto start = std::chrono::steady_clock::now();
+
+	Parallel::For(children.size(), [&](std::size_t child_index)
+	{
+		// Each worker thread owns a machine; the rom it executes is shared with the parent
+		Cartridge::Insert(rom);
+		Emulator::Init();
+		parent.Restore();
+
+		const InputSequence& inputs = children[child_index];
+		for (u8 buttons : inputs)
+		{
+			Joypad::SetButtons(buttons);
+			Emulator::RunFrame();
+		}
+
+		scores[child_index] = score();
+		child_frames += inputs.size();
+	}, threads);
+
+	if (stats)
+	{
+		stats->childFrames = child_frames;
+		stats->hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	return scores;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "types.h"
+
+#include <functional>
+#include <vector>
+
+struct Snapshot;
+
+namespace Search
+{
+	// One Joypad::BUTTON mask per frame
+	typedef std::vector<u8> InputSequence;
+
+	// Called on the child's worker thread once its inputs have run. Read guest RAM through Bus::LoadU8.
+	typedef std::function<int()> ScoreFunction;
+
+	struct Stats
+	{
+		u64 childFrames = 0;
+		double hostSeconds = 0.0;
+
+		double ChildFramesPerSecond() const { return hostSeconds > 0.0 ? childFrames / hostSeconds : 0.0; }
+	};
+
+	// Forks the parent into one child per input sequence and runs them headless across worker threads.
+	// The parent machine on the calling thread is left untouched. Returns the score of each child, in order.
+	std::vector<int> Fork(const Snapshot& parent, const std::vector<InputSequence>& children, const ScoreFunction& score, unsigned threads = 0, Stats* stats = nullptr);
+}
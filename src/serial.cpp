@@ -0,0 +1,54 @@
+#include "serial.h"
+#include "interrupts.h"
+#include "constants.h"
+
+thread_local u8 serialData;		// FF01 SB
+thread_local u8 serialControl;	// FF02 SC
+thread_local std::string serialOutput;
+
+namespace Serial
+{
+	const u8 TRANSFER_START = 0x80;
+	const u8 INTERNAL_CLOCK = 0x01;
+
+	void Init()
+	{
+		serialData = 0;
+		serialControl = 0;
+		serialOutput.clear();
+	}
+
+	const std::string& GetOutput() { return serialOutput; }
+	void ClearOutput() { serialOutput.clear(); }
+
+	void SaveState(State& state)
+	{
+		state.data = serialData;
+		state.control = serialControl;
+	}
+
+	void LoadState(const State& state)
+	{
+		serialData = state.data;
+		serialControl = state.control;
+	}
+
+	u8 R_SB() { return serialData; }
+	u8 R_SC() { return serialControl | 0x7E; }
+
+	void W_SB(u8 v) { serialData = v; }
+
+	void W_SC(u8 v)
+	{
+		serialControl = v;
+
+		if ((serialControl & TRANSFER_START) && (serialControl & INTERNAL_CLOCK))
+		{
+			// No link partner, so the byte shifts out and 0xFF shifts in
+			serialOutput += (char)serialData;
+			serialData = 0xFF;
+			serialControl &= ~TRANSFER_START;
+			Interrupts::Raise(INTERRUPT_FLAGS::SERIAL);
+		}
+	}
+}
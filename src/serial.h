@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types.h"
+
+#include <string>
+
+// Serial port with nothing on the other end. Transfers using the internal clock complete immediately,
+// and every byte sent is captured so test roms can be checked headless.
+namespace Serial
+{
+	struct State
+	{
+		u8 data;
+		u8 control;
+	};
+
+	void Init();
+
+	// Every byte sent since Init/ClearOutput
+	const std::string& GetOutput();
+	void ClearOutput();
+
+	void SaveState(State& state);
+	void LoadState(const State& state);
+
+	u8 R_SB();
+	u8 R_SC();
+
+	void W_SB(u8 v);
+	void W_SC(u8 v);
+}
@@ -0,0 +1,38 @@
+#include "snapshot.h"
+
+#include "codecache.h"
+#include "emulator.h"
+#include "memory.h"
+#include "tilecache.h"
+
+#include <string.h>
+
+void Snapshot::Capture()
+{
+	CPU::SaveState(cpu);
+	Interrupts::SaveState(interrupts);
+	Timer::SaveState(timer);
+	PPU::SaveState(ppu);
+	Joypad::SaveState(joypad);
+	Serial::SaveState(serial);
+	Cartridge::SaveState(cartridge);
+	clock = Emulator::GetClock();
+	memcpy(memory, Memory::memory, sizeof(memory));
+}
+
+void Snapshot::Restore() const
+{
+	Emulator::SetClock(clock);
+	CPU::LoadState(cpu);
+	Interrupts::LoadState(interrupts);
+	Timer::LoadState(timer);
+	PPU::LoadState(ppu);
+	Joypad::LoadState(joypad);
+	Serial::LoadState(serial);
+	Cartridge::LoadState(cartridge);
+	memcpy(Memory::memory, memory, sizeof(memory));
+
+	// Every RAM byte may have changed under cached code
+	CodeCache::InvalidateRange(0x8000, 0x10000);
+	TileCache::Init();
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "types.h"
+
+#include "cartridge.h"
+#include "cpu.h"
+#include "interrupts.h"
+#include "joypad.h"
+#include "ppu.h"
+#include "serial.h"
+#include "timer.h"
+
+// A copy of everything owned by the calling thread's machine. The boot rom and cartridge rom are
+// read-only and shared, so they are not part of the snapshot.
+struct Snapshot
+{
+	CPU::State cpu;
+	Interrupts::State interrupts;
+	Timer::State timer;
+	PPU::State ppu;
+	Joypad::State joypad;
+	Serial::State serial;
+	Cartridge::State cartridge;
+	u64 clock;
+	u8 memory[0x10000];
+
+	void Capture();
+	void Restore() const;
+};
@@ -0,0 +1,34 @@
+#include "tilecache.h"
+
+#include "memory.h"
+#include "pixelkernels.h"
+
+thread_local bool TileCache::dirtyTiles[TileCache::TILE_COUNT];
+thread_local u8 TileCache::tiles[TileCache::TILE_COUNT][8][8];
+
+void TileCache::Init()
+{
+	InvalidateRange(TILE_DATA_START, TILE_DATA_END);
+}
+
+void TileCache::InvalidateRange(u16 begin, u32 end)
+{
+	if (begin < TILE_DATA_START)
+	{
+		begin = TILE_DATA_START;
+	}
+	if (end > TILE_DATA_END)
+	{
+		end = TILE_DATA_END;
+	}
+	for (u32 address = begin & ~0x0F; address < end; address += 16)
+	{
+		dirtyTiles[(address - TILE_DATA_START) >> 4] = true;
+	}
+}
+
+void TileCache::Decode(int tile)
+{
+	PixelKernels::DecodeTile(&Memory::memory[TILE_DATA_START + tile * 16], &tiles[tile][0][0]);
+	dirtyTiles[tile] = false;
+}
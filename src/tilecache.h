@@ -0,0 +1,43 @@
+#pragma once
+#include "types.h"
+
+// The 384 tiles in VRAM decoded to one color index per pixel, so rendering reads a row of 8 indices instead of
+// combining two bitplane bytes per pixel. Bus::StoreU8 marks the tile under a VRAM store dirty and it is decoded
+// again the next time it is read.
+namespace TileCache
+{
+	const int TILE_COUNT = 384;
+	const u16 TILE_DATA_START = 0x8000;
+	const u32 TILE_DATA_END = 0x9800;
+
+	// Indexed by tile, row and pixel
+	extern thread_local u8 tiles[TILE_COUNT][8][8];
+	extern thread_local bool dirtyTiles[TILE_COUNT];
+
+	// Marks every tile dirty, for a reset or restored machine
+	void Init();
+
+	// Marks the tiles overlapping [begin, end) dirty, for writes that don't go through Bus::StoreU8
+	void InvalidateRange(u16 begin, u32 end);
+
+	void Decode(int tile);
+
+	inline void NotifyStore(u16 address)
+	{
+		if (address < TILE_DATA_END)
+		{
+			dirtyTiles[(address - TILE_DATA_START) >> 4] = true;
+		}
+	}
+
+	// The 8 color indices, leftmost first, of the tile row whose bitplanes are at address
+	inline const u8* GetRow(u16 address)
+	{
+		const int tile = (address - TILE_DATA_START) >> 4;
+		if (dirtyTiles[tile])
+		{
+			Decode(tile);
+		}
+		return tiles[tile][(address >> 1) & 0x07];
+	}
+}
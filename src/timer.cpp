@@ -1,146 +1,243 @@
 #include <assert.h>
 #include "timer.h"
-#include "cpu.h"
+#include "emulator.h"
+#include "interrupts.h"
 #include "constants.h"
+#include "instrument.h"
 
+// The timer is not stepped per cycle, DIV and TIMA are derived from the clock when they are observed. Tick t is the
+// divider increment at the start of cycle t, so during cycle t (e.g. for the CPU's bus accesses) ticks up to and
+// including t have happened.
 
-u16split divider;		// FF04 DIV
-u8 timerCounter;		// FF05 TIMA
-u8 timerModulo;			// FF06 TMA
-u8 timerControl;		// FF07 TAC
+const u64 NEVER = ~0ULL;
 
-int delayedInterupt = -1;
+thread_local u64 dividerOrigin;		// FF04 DIV is the low 16 bits of the ticks since this one
+thread_local u8 timerCounter;		// FF05 TIMA
+thread_local u8 timerModulo;		// FF06 TMA
+thread_local u8 timerControl;		// FF07 TAC
+
+thread_local u64 processedTicks;	// TIMA is up to date with every tick before this one
+thread_local u64 reloadTick = NEVER;	// TIMA overflowed, it is reloaded from TMA and the interrupt raised on this tick
+
+thread_local u64 Timer::nextInterrupt = NEVER;
 
 
 namespace Timer
 {
-	void IncrementTimer();
-	bool TimerBit();
-	void UpdateDivider(u16 value);
+	u64 CurrentTicks();
+	u64 Period();
+	bool TimerBit(u64 ticks);
+	void Advance(u64 ticks);
+	void IncrementTimer(u64 ticks);
+	void UpdateNextInterrupt();
 
 
 	void Init()
 	{
-		divider.Full = 0;
+		dividerOrigin = Emulator::GetClock();
 		timerCounter = 0;
 		timerModulo = 0;
 		timerControl = 0; // todo(luke) : what shoud the default value be?
+		processedTicks = Emulator::GetClock();
+		reloadTick = NEVER;
+		UpdateNextInterrupt();
 	}
 
-	void Step()
+	void Update()
 	{
-		if (delayedInterupt > -1)
-		{
-			delayedInterupt--;
-			if (delayedInterupt == -1)
-			{
-				timerCounter = timerModulo;
-				CPU::RaiseInterrupt(INTERRUPT_FLAGS::TIMER);
-			}
-		}
+		INSTRUMENT_SCOPE(TIMER);
 
-		UpdateDivider(divider.Full + 1);
+		Advance(CurrentTicks());
+		UpdateNextInterrupt();
 	}
 
 
-	void IncrementTimer()
+	u64 CurrentTicks()
 	{
-		if (timerCounter == 0xFF)
+		return Emulator::GetClock() + 1;
+	}
+
+	// Ticks between TIMA increments, which happen on the falling edge of divider bit 9, 3, 5 or 7
+	u64 Period()
+	{
+		switch (timerControl & 0x03)
 		{
-			timerCounter++;
-			delayedInterupt = 4;
+		case 0: return 1 << 10;
+		case 1: return 1 << 4;
+		case 2: return 1 << 6;
+		case 3: return 1 << 8;
+		}
+		assert(false);
+		return 0;
+	}
+
+	// The selected divider bit ANDed with the enable, once every tick before ticks has happened
+	bool TimerBit(u64 ticks)
+	{
+		if (timerControl & 0x04)
+		{
+			return (ticks - dividerOrigin) & (Period() >> 1);
 		}
 		else
 		{
-			timerCounter++;
+			return false;
 		}
-
 	}
 
-	bool TimerBit()
+	// Runs every tick before ticks
+	void Advance(u64 ticks)
 	{
-		if (timerControl & 0x04)
+		while (processedTicks < ticks)
 		{
-			int bit = 0;
-			switch (timerControl & 0x03)
+			if (processedTicks == reloadTick)
 			{
-			case 0: bit = 1 << 9; break;
-			case 1: bit = 1 << 3; break;
-			case 2: bit = 1 << 5; break;
-			case 3: bit = 1 << 7; break;
-			default:
-				assert(false);
-				break;
+				reloadTick = NEVER;
+				timerCounter = timerModulo;
+				Interrupts::Raise(INTERRUPT_FLAGS::TIMER);
 			}
 
-			return divider.Full & bit;
+			const u64 until = ticks < reloadTick ? ticks : reloadTick;
+			if (timerControl & 0x04)
+			{
+				// The first tick that takes the divider to a multiple of the period
+				const u64 period = Period();
+				const u64 first = processedTicks + ((dividerOrigin - processedTicks - 1) & (period - 1));
+				if (first < until)
+				{
+					const u64 increments = (until - 1 - first) / period + 1;
+					const u64 room = 0x100 - timerCounter;
+					if (increments >= room)
+					{
+						const u64 overflow = first + (room - 1) * period;
+						timerCounter = 0xFF;
+						IncrementTimer(overflow + 1);
+						processedTicks = overflow + 1;
+						continue;
+					}
+					timerCounter += (u8)increments;
+				}
+			}
+			processedTicks = until;
+		}
+	}
+
+	// An increment that happened once every tick before ticks had
+	void IncrementTimer(u64 ticks)
+	{
+		if (timerCounter == 0xFF)
+		{
+			// TIMA reads 0 for 4 cycles before the reload
+			timerCounter = 0;
+			reloadTick = ticks + 4;
 		}
 		else
 		{
-			return false;
+			timerCounter++;
 		}
 	}
 
-	void UpdateDivider(u16 value)
+	void UpdateNextInterrupt()
 	{
-		int bit = 0;
-		switch (timerControl & 0x03)
+		if (reloadTick != NEVER)
 		{
-		case 0: bit = 1 << 9; break;
-		case 1: bit = 1 << 3; break;
-		case 2: bit = 1 << 5; break;
-		case 3: bit = 1 << 7; break;
-		default:
-			assert(false);
-			break;
+			nextInterrupt = reloadTick;
 		}
-
-		bool prev = TimerBit();
-		divider.Full = value;
-		bool post = TimerBit();
-
-		if (prev == true && post == false)
+		else if (timerControl & 0x04)
 		{
-			IncrementTimer();
+			const u64 period = Period();
+			const u64 first = processedTicks + ((dividerOrigin - processedTicks - 1) & (period - 1));
+			nextInterrupt = first + (0xFF - timerCounter) * period + 1 + 4;
+		}
+		else
+		{
+			nextInterrupt = NEVER;
 		}
 	}
 
 
-	u8 R_DIV() { return divider.H; }
-	u8 R_TIMA() { return timerCounter; }
+	// Only valid between cycles, as from a snapshot taken between frames
+	void SaveState(State& state)
+	{
+		const u64 ticks = Emulator::GetClock();
+		Advance(ticks);
+		state.divider = (u16)(ticks - dividerOrigin);
+		state.counter = timerCounter;
+		state.modulo = timerModulo;
+		state.control = timerControl;
+		state.delayedInterrupt = reloadTick != NEVER ? (int)(reloadTick - ticks) : -1;
+	}
+
+	// Expects the clock to be restored first
+	void LoadState(const State& state)
+	{
+		const u64 ticks = Emulator::GetClock();
+		dividerOrigin = ticks - state.divider;
+		timerCounter = state.counter;
+		timerModulo = state.modulo;
+		timerControl = state.control;
+		processedTicks = ticks;
+		reloadTick = state.delayedInterrupt > -1 ? ticks + state.delayedInterrupt : NEVER;
+		UpdateNextInterrupt();
+	}
+
+
+	u8 R_DIV() { return (u8)((CurrentTicks() - dividerOrigin) >> 8); }
+	u8 R_TIMA() { Advance(CurrentTicks()); return timerCounter; }
 	u8 R_TMA() { return timerModulo; }
-	u8 R_TAC() { return timerControl; }
+	u8 R_TAC() { return timerControl | 0xF8; }
 
-	void W_DIV(u8 v) { UpdateDivider(0); }
+	void W_DIV(u8 v)
+	{
+		const u64 ticks = CurrentTicks();
+		Advance(ticks);
+
+		// resetting the divider is a falling edge if the selected bit was set
+		bool prev = TimerBit(ticks);
+		dividerOrigin = ticks;
+		if (prev)
+		{
+			IncrementTimer(ticks);
+		}
+		UpdateNextInterrupt();
+	}
 
 	void W_TIMA(u8 v)
 	{
+		Advance(CurrentTicks());
 		timerCounter = v;
 
 		// writing to timer counter suppresses any pending overflow effects
-		delayedInterupt = -1;
+		reloadTick = NEVER;
+		UpdateNextInterrupt();
 	}
 
 	void W_TMA(u8 v)
 	{
+		Advance(CurrentTicks());
 		timerModulo = v;
 
 		// white the modulo is being loaded any writes changes the timer counter imidiately
-		if (delayedInterupt > -1)
+		if (reloadTick != NEVER)
 		{
 			timerCounter = timerModulo;
 		}
+		UpdateNextInterrupt();
 	}
 
 	void W_TAC(u8 v)
 	{
-		bool prev = TimerBit();
-		timerControl = 0;
-		bool post = TimerBit();
+		const u64 ticks = CurrentTicks();
+		Advance(ticks);
+
+		// disabling the timer or selecting a bit that is clear is a falling edge if the old one was set
+		bool prev = TimerBit(ticks);
+		timerControl = v & 0x07;
+		bool post = TimerBit(ticks);
 
-		if (prev == false && post == true)
+		if (prev == true && post == false)
 		{
-			IncrementTimer();
+			IncrementTimer(ticks);
 		}
+		UpdateNextInterrupt();
 	}
-}
\ No newline at end of file
+}
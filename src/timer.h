@@ -4,8 +4,24 @@
 
 namespace Timer
 {
+	struct State
+	{
+		u16 divider;
+		u8 counter;
+		u8 modulo;
+		u8 control;
+		int delayedInterrupt;
+	};
+
+	// Cycle on which TIMA is next reloaded and the timer interrupt raised, Update needs calling on or after it
+	extern thread_local u64 nextInterrupt;
+
 	void Init();
-	void Step();
+	// Catches the timer up to the current cycle
+	void Update();
+
+	void SaveState(State& state);
+	void LoadState(const State& state);
 
 
 	u8 R_DIV();
@@ -0,0 +1,136 @@
+#include "trace.h"
+
+#include "cpu.h"
+#include "emulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <assert.h>
+
+thread_local bool Trace::enabled = false;
+
+const std::size_t RING_CAPACITY = 1 << 20; // records, must be a power of two
+const std::size_t RING_MASK = RING_CAPACITY - 1;
+
+// Single producer (the emulation thread), single consumer (the writer thread)
+static std::vector<Trace::Record> ring;
+static std::atomic<std::size_t> ring_head(0); // next slot the producer writes
+static std::atomic<std::size_t> ring_tail(0); // next slot the consumer reads
+static std::atomic<bool> writer_running(false);
+static std::thread writer_thread;
+static FILE* trace_file = nullptr;
+
+// The ring, writer and file above are shared by the process, so one machine is traced at a time: the thread that
+// started tracing owns them until it stops, and Start or Stop from any other thread is refused.
+static std::atomic<std::thread::id> traced_thread;
+
+static void DrainRing()
+{
+	std::size_t tail = ring_tail.load(std::memory_order_relaxed);
+	std::size_t head = ring_head.load(std::memory_order_acquire);
+	while (tail != head)
+	{
+		// Write up to the end of the buffer in one go, wrapping on the next pass
+		std::size_t start = tail & RING_MASK;
+		std::size_t count = std::min(head - tail, RING_CAPACITY - start);
+		fwrite(&ring[start], sizeof(Trace::Record), count, trace_file);
+		tail += count;
+		ring_tail.store(tail, std::memory_order_release);
+	}
+}
+
+static void WriterLoop()
+{
+	while (writer_running.load(std::memory_order_acquire))
+	{
+		if (ring_head.load(std::memory_order_acquire) == ring_tail.load(std::memory_order_relaxed))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+		DrainRing();
+	}
+	DrainRing();
+}
+
+// Finishes writing the trace in progress, if any. The caller owns tracing.
+static void CloseTrace()
+{
+	if (!trace_file)
+	{
+		return;
+	}
+
+	writer_running = false;
+	writer_thread.join();
+	fclose(trace_file);
+	trace_file = nullptr;
+}
+
+bool Trace::Start(const std::string& path)
+{
+	std::thread::id owner;
+	if (!traced_thread.compare_exchange_strong(owner, std::this_thread::get_id()) && owner != std::this_thread::get_id())
+	{
+		assert(false && "Another thread's machine is being traced, only one can be at a time");
+		return false;
+	}
+
+	enabled = false;
+	CloseTrace();
+
+	trace_file = fopen(path.c_str(), "wb");
+	if (!trace_file)
+	{
+		traced_thread = std::thread::id();
+		return false;
+	}
+	fwrite(FILE_MAGIC, sizeof(FILE_MAGIC), 1, trace_file);
+
+	ring.resize(RING_CAPACITY);
+	ring_head = 0;
+	ring_tail = 0;
+	writer_running = true;
+	writer_thread = std::thread(WriterLoop);
+
+	enabled = true;
+	return true;
+}
+
+void Trace::Stop()
+{
+	enabled = false;
+	if (traced_thread.load() != std::this_thread::get_id())
+	{
+		assert(traced_thread.load() == std::thread::id() && "Stop tracing from the thread that started it");
+		return;
+	}
+	CloseTrace();
+	traced_thread = std::thread::id();
+}
+
+void Trace::RecordOpcode(u16 pc, u8 opcode)
+{
+	std::size_t head = ring_head.load(std::memory_order_relaxed);
+	while (head - ring_tail.load(std::memory_order_acquire) == RING_CAPACITY)
+	{
+		// Full, the trace must be lossless so wait for the writer
+		std::this_thread::yield();
+	}
+
+	Record& record = ring[head & RING_MASK];
+	record.cycle = Emulator::GetClock();
+	record.pc = pc;
+	record.af = reg.AF;
+	record.bc = reg.BC;
+	record.de = reg.DE;
+	record.hl = reg.HL;
+	record.sp = reg.SP;
+	record.opcode = opcode;
+
+	ring_head.store(head + 1, std::memory_order_release);
+}
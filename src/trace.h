@@ -0,0 +1,37 @@
+#pragma once
+#include "types.h"
+
+#include <string>
+
+// Binary execution trace. The CPU writes a fixed-size record per opcode into a lock-free ring buffer,
+// and a background thread drains it to disk. Decode the file with gbemu_tracedump.
+namespace Trace
+{
+	const char FILE_MAGIC[8] = { 'G', 'B', 'T', 'R', 'A', 'C', 'E', '1' };
+
+	// State before the opcode executes
+	struct Record
+	{
+		u64 cycle;
+		u16 pc;
+		u16 af;
+		u16 bc;
+		u16 de;
+		u16 hl;
+		u16 sp;
+		u8 opcode;
+		u8 padding[3];
+	};
+	static_assert(sizeof(Record) == 24, "trace records are written to disk as is");
+
+	// Checked by the CPU before every opcode, so tracing costs a single branch when disabled
+	extern thread_local bool enabled;
+
+	// Starts tracing the calling thread's machine. Only one machine per process can be traced at a time, this
+	// fails while another thread's is.
+	bool Start(const std::string& path);
+	// Flushes everything recorded and closes the file, from the thread that started tracing
+	void Stop();
+
+	void RecordOpcode(u16 pc, u8 opcode);
+}
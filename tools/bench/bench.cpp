@@ -0,0 +1,612 @@
+// Micro and macro benchmarks for the emulator core. Results go to stdout and to a JSON file tagged
+// with the git revision, so runs can be compared against each other.
+//
+//   gbemu_bench [-micro] [-macro] [-fork] [-rom path]... [-frames n] [-threads n] [-bootrom path] [-out results.json] [-nofusion] [-scanline] [-writerom path]
+//
+// With none of -micro, -macro and -fork every suite runs. -fork measures Search::Fork on the last rom and checks every
+// child's score against running the same inputs one after another on a single machine. -nofusion turns off fused superinstructions for the micro and fork suites, -scanline runs the PPU as gbemu -scanline does. assets\cpu_instrs.gb is always part of the macro suite.
+//
+// The macro suite runs every rom interpreted and with fused superinstructions, and recompiled as well when a compiled
+// translation of it is linked in. It also runs a built in rom whose code lives in rom, like a game's, where cpu_instrs
+// runs its tests from work RAM that static recompilation can't reach. -writerom saves the built in rom, to regenerate
+// its translation with
+//   gbemu_bench -writerom bench.gb && gbemu_recompile bench.gb -out tools\bench\benchrom_recompiled.cpp
+
+#include "bootrom.h"
+#include "Bus.h"
+#include "cartridge.h"
+#include "constants.h"
+#include "cpu.h"
+#include "emulator.h"
+#include "fusion.h"
+#include "joypad.h"
+#include "memory.h"
+#include "ppu.h"
+#include "recompiled.h"
+#include "search.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#define popen _popen
+#define pclose _pclose
+#define NULL_DEVICE "nul"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* default_rom_path = "assets\\cpu_instrs.gb";
+static const int opcode_iterations = 100000;
+static const int bus_load_iterations = 2000000;
+static const int ppu_frames = 60;
+static const int fork_warmup_frames = 120;
+static const int fork_children = 64;
+static const int fork_child_frames = 60;
+static const int macro_runs = 3; // the best one counts, the rest absorb scheduling noise
+static const char* bench_rom_name = "(built in)";
+
+struct OpcodeResult
+{
+	const char* table;
+	int opcode;
+	double nsPerOp;
+};
+
+struct RegionResult
+{
+	const char* region;
+	double nsPerLoad;
+};
+
+struct RomResult
+{
+	std::string rom;
+	int frames = 0;
+	double interpretedFps = 0.0;
+	double fusedFps = 0.0;
+	double recompiledFps = 0.0; // 0 when no translation of the rom is linked in
+};
+
+struct ForkResult
+{
+	int children = 0;
+	int mismatches = 0;
+	double childFps = 0.0;
+	double serialFps = 0.0;
+};
+
+static volatile std::size_t sink; // keeps the optimiser from discarding measured work
+
+static double NanosecondsSince(Clock::time_point start, double count)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+}
+
+static std::string GitRevision()
+{
+	std::string revision;
+	if (FILE* pipe = popen("git describe --always --dirty 2>" NULL_DEVICE, "r"))
+	{
+		char line[128];
+		if (fgets(line, sizeof(line), pipe))
+		{
+			revision = line;
+			while (!revision.empty() && (revision.back() == '\n' || revision.back() == '\r'))
+			{
+				revision.pop_back();
+			}
+		}
+		pclose(pipe);
+	}
+	return revision.empty() ? "unknown" : revision;
+}
+
+static bool IsUnusedOpcode(int opcode)
+{
+	switch (opcode)
+	{
+	case 0xD3: case 0xDB: case 0xDD: case 0xE3: case 0xE4: case 0xEB: case 0xEC: case 0xED: case 0xF4: case 0xFC: case 0xFD:
+		return true;
+	}
+	return false;
+}
+
+// Runs a single handler over and over from the same starting state. Operands come from WRAM filled with
+// 0x80, so immediate addresses land in VRAM/HRAM and register addresses in WRAM; nothing writes to the rom.
+static double BenchOpcode(operation handler)
+{
+	Registers start;
+	start.AF = 0x01B0;
+	start.BC = 0xC100;
+	start.DE = 0xC200;
+	start.HL = 0xC300;
+	start.SP = 0xDFF0;
+	start.PC = 0xC000;
+
+	std::size_t total_cycles = 0;
+	auto begin = Clock::now();
+	for (int i = 0; i < opcode_iterations; ++i)
+	{
+		reg = start;
+		total_cycles += handler();
+	}
+	double ns = NanosecondsSince(begin, opcode_iterations);
+	sink = total_cycles;
+	return ns;
+}
+
+static std::vector<OpcodeResult> BenchOpcodes()
+{
+	Emulator::Init();
+	for (u16 address = 0xC000; address < 0xC400; ++address)
+	{
+		Memory::StoreU8(address, 0x80);
+	}
+
+	std::vector<OpcodeResult> results;
+	for (int opcode = 0; opcode < 256; ++opcode)
+	{
+		if (IsUnusedOpcode(opcode) || opcode == 0xCB)
+		{
+			continue;
+		}
+		results.push_back({ "operations", opcode, BenchOpcode(operations[opcode]) });
+	}
+	for (int opcode = 0; opcode < 256; ++opcode)
+	{
+		results.push_back({ "exops", opcode, BenchOpcode(exops[opcode]) });
+	}
+	return results;
+}
+
+static std::vector<RegionResult> BenchBusLoads()
+{
+	struct Region
+	{
+		const char* name;
+		u32 start;
+		u32 end;
+	};
+	const Region regions[] =
+	{
+		{ "bootrom", 0x0000, 0x0100 },
+		{ "rom0", 0x0100, 0x4000 },
+		{ "romx", 0x4000, 0x8000 },
+		{ "vram", 0x8000, 0xA000 },
+		{ "eram", 0xA000, 0xC000 },
+		{ "wram", 0xC000, 0xE000 },
+		{ "echo", 0xE000, 0xFE00 },
+		{ "io_ly", 0xFF44, 0xFF45 },
+		{ "hram", 0xFF80, 0xFFFF },
+		{ "ie", 0xFFFF, 0x10000 },
+	};
+
+	// Boot rom stays mapped, BOOTROM_SWITCH is zero after init
+	Emulator::Init();
+
+	std::vector<RegionResult> results;
+	for (const Region& region : regions)
+	{
+		const u32 size = region.end - region.start;
+		std::size_t total = 0;
+		u32 offset = 0;
+
+		auto begin = Clock::now();
+		for (int i = 0; i < bus_load_iterations; ++i)
+		{
+			total += Bus::LoadU8(u16(region.start + offset));
+			offset = (offset + 1 == size) ? 0 : offset + 1;
+		}
+		results.push_back({ region.name, NanosecondsSince(begin, bus_load_iterations) });
+		sink = total;
+	}
+	return results;
+}
+
+static void BenchPPU(double& ns_per_scanline, double& ns_per_frame)
+{
+	Emulator::Init();
+	Memory::StoreU8((u16)SpecialRegister::VIDEO_LCD_CONTROL, 0x91);
+
+	// Visible scanlines only, timed one line at a time
+	double scanline_ns = 0.0;
+	int scanlines = 0;
+	auto frames_begin = Clock::now();
+	for (int frame = 0; frame < ppu_frames; ++frame)
+	{
+		for (int line = 0; line < 154; ++line)
+		{
+			const bool visible = Memory::LoadU8((u16)SpecialRegister::VIDEO_CURRENT_SCANLINE) < gb_height;
+			auto line_begin = Clock::now();
+			for (int cycle = 0; cycle < 114 * 4; ++cycle)
+			{
+				PPU::Step();
+			}
+			if (visible)
+			{
+				scanline_ns += NanosecondsSince(line_begin, 1);
+				scanlines++;
+			}
+		}
+	}
+	ns_per_frame = NanosecondsSince(frames_begin, ppu_frames);
+	ns_per_scanline = scanlines ? scanline_ns / scanlines : 0.0;
+}
+
+// 32KB, no mapper. Turns the LCD on and then loops forever with interrupts off: a checksum over the first 8KB of
+// itself, stored to work RAM, and a call to a shift loop mixing the sum.
+static Cartridge::Rom BuildBenchRom()
+{
+	std::vector<u8> rom(0x8000, 0);
+	u16 at = 0;
+	auto emit = [&](std::initializer_list<int> bytes)
+	{
+		for (int byte : bytes)
+		{
+			rom[at++] = u8(byte);
+		}
+	};
+	// Operand of a JR whose opcode was just emitted
+	auto relative = [&](u16 target) { return int(u8(target - (at + 1))); };
+
+	at = 0x0150;
+	const u16 mix = at;
+	emit({ 0x06, 0x08 });                         // LD B,8
+	const u16 mix_loop = at;
+	emit({ 0xCB, 0x23, 0xCB, 0x12, 0x05, 0x20 }); // SLA E; RL D; DEC B; JR NZ,mix_loop
+	emit({ relative(mix_loop) });
+	emit({ 0x7A, 0xEA, 0x02, 0xC0, 0xC9 });       // LD A,D; LD (C002),A; RET
+
+	const u16 start = at;
+	emit({ 0xF3, 0x31, 0xFE, 0xFF });             // DI; LD SP,FFFE
+	emit({ 0x3E, 0x91, 0xE0, 0x40 });             // LD A,91; LDH (40),A
+	const u16 main_loop = at;
+	emit({ 0x21, 0x00, 0x00 });                   // LD HL,0000
+	emit({ 0x01, 0x00, 0x20 });                   // LD BC,2000
+	emit({ 0x11, 0x00, 0x00 });                   // LD DE,0000
+	const u16 sum_loop = at;
+	emit({ 0x2A, 0x83, 0x5F, 0x30, 0x01, 0x14 }); // LD A,(HL+); ADD A,E; LD E,A; JR NC,+1; INC D
+	emit({ 0x0B, 0x78, 0xB1, 0x20 });             // DEC BC; LD A,B; OR C; JR NZ,sum_loop
+	emit({ relative(sum_loop) });
+	emit({ 0x7B, 0xEA, 0x00, 0xC0 });             // LD A,E; LD (C000),A
+	emit({ 0x7A, 0xEA, 0x01, 0xC0 });             // LD A,D; LD (C001),A
+	emit({ 0xCD, mix & 0xFF, mix >> 8, 0x18 });   // CALL mix; JR main_loop
+	emit({ relative(main_loop) });
+
+	at = 0x0100;
+	emit({ 0x00, 0xC3, start & 0xFF, start >> 8 }); // NOP; JP start
+
+	const char title[] = "GBEMU BENCH";
+	std::copy(title, title + sizeof(title) - 1, rom.begin() + 0x134);
+	u8 header_checksum = 0;
+	for (u16 address = 0x134; address < 0x14D; ++address)
+	{
+		header_checksum = u8(header_checksum - rom[address] - 1);
+	}
+	rom[0x14D] = header_checksum;
+	u16 global_checksum = 0;
+	for (std::size_t address = 0; address < rom.size(); ++address)
+	{
+		if (address != 0x14E && address != 0x14F)
+		{
+			global_checksum = u16(global_checksum + rom[address]);
+		}
+	}
+	rom[0x14E] = u8(global_checksum >> 8);
+	rom[0x14F] = u8(global_checksum);
+	return std::make_shared<const std::vector<u8>>(std::move(rom));
+}
+
+// Where the boot rom leaves off, for roms that don't need its checks
+static void SkipBootRom()
+{
+	Memory::StoreU8((u16)SpecialRegister::BOOTROM_SWITCH, 1);
+	reg.PC = 0x0100;
+	reg.SP = 0xFFFE;
+}
+
+// How instructions get run in a macro run, each on its own
+enum class DISPATCH
+{
+	INTERPRETED,
+	FUSED,
+	RECOMPILED,
+};
+
+// Best frame rate of a few runs from power on, or 0 if recompiled was asked for and nothing linked in matches
+static double MeasureFps(const Cartridge::Rom& rom, bool boot, int frames, DISPATCH dispatch)
+{
+	const bool recompiled = dispatch == DISPATCH::RECOMPILED;
+	Fusion::SetEnabled(dispatch == DISPATCH::FUSED);
+	Recompiled::allowed = recompiled;
+	Cartridge::Insert(rom);
+	double best = 0.0;
+	for (int run = 0; run < macro_runs; ++run)
+	{
+		Emulator::Init();
+		if (recompiled && !Recompiled::enabled)
+		{
+			break;
+		}
+		if (!boot)
+		{
+			SkipBootRom();
+		}
+
+		auto begin = Clock::now();
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			Emulator::RunFrame();
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+		best = std::max(best, seconds > 0.0 ? frames / seconds : 0.0);
+	}
+	Cartridge::Insert(nullptr);
+	Recompiled::allowed = true;
+	return best;
+}
+
+static RomResult BenchRom(const std::string& name, const Cartridge::Rom& rom, bool boot, int frames)
+{
+	RomResult result;
+	result.rom = name;
+	result.frames = frames;
+	result.interpretedFps = MeasureFps(rom, boot, frames, DISPATCH::INTERPRETED);
+	result.fusedFps = MeasureFps(rom, boot, frames, DISPATCH::FUSED);
+	result.recompiledFps = MeasureFps(rom, boot, frames, DISPATCH::RECOMPILED);
+	return result;
+}
+
+// The mapped rom banks, VRAM, work RAM and HRAM, so a child that ran different code, on a different rom or with
+// different buttons, scores differently
+static int ScoreMachine()
+{
+	u32 hash = 2166136261u;
+	auto hash_range = [&](u32 begin, u32 end)
+	{
+		for (u32 address = begin; address < end; ++address)
+		{
+			hash = (hash ^ Bus::LoadU8(u16(address))) * 16777619u;
+		}
+	};
+	hash_range(0x0000, 0xA000);
+	hash_range(0xC000, 0xE000);
+	hash_range(0xFF80, 0xFFFF);
+	return int(hash);
+}
+
+static ForkResult BenchFork(const std::string& path, unsigned threads)
+{
+	ForkResult result;
+
+	// Inserted rather than loaded as the game rom, so the children have to pick it up from the parent
+	Cartridge::Rom rom = Cartridge::LoadRom(path);
+	if (!rom)
+	{
+		fprintf(stderr, "can't load %s\n", path.c_str());
+		return result;
+	}
+	Cartridge::Insert(rom);
+	Emulator::Init();
+	for (int frame = 0; frame < fork_warmup_frames; ++frame)
+	{
+		Emulator::RunFrame();
+	}
+	auto parent = std::make_unique<Snapshot>();
+	parent->Capture();
+
+	std::vector<Search::InputSequence> children(fork_children);
+	u32 seed = 1;
+	for (Search::InputSequence& inputs : children)
+	{
+		for (int frame = 0; frame < fork_child_frames; ++frame)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			inputs.push_back(u8(seed >> 24));
+		}
+	}
+
+	Search::Stats stats;
+	const std::vector<int> scores = Search::Fork(*parent, children, ScoreMachine, threads, &stats);
+	result.children = fork_children;
+	result.childFps = stats.ChildFramesPerSecond();
+
+	// The same children run one after another on this thread's machine
+	auto begin = Clock::now();
+	for (std::size_t child = 0; child < children.size(); ++child)
+	{
+		parent->Restore();
+		for (u8 buttons : children[child])
+		{
+			Joypad::SetButtons(buttons);
+			Emulator::RunFrame();
+		}
+		if (ScoreMachine() != scores[child])
+		{
+			result.mismatches++;
+		}
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	result.serialFps = seconds > 0.0 ? fork_children * fork_child_frames / seconds : 0.0;
+
+	Cartridge::Insert(nullptr);
+	return result;
+}
+
+static std::string EscapeJson(const std::string& text)
+{
+	std::string escaped;
+	for (char c : text)
+	{
+		if (c == '\\' || c == '"')
+		{
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+int main(int argc, char** argv)
+{
+	bool run_micro = false;
+	bool run_macro = false;
+	bool run_fork = false;
+	unsigned threads = 0;
+	int frames = 600;
+	bool fusion = true;
+	std::string out_path = "bench_results.json";
+	std::string write_rom_path;
+	std::vector<std::string> roms = { default_rom_path };
+
+	for (int i = 1; i < argc;)
+	{
+		std::string arg = argv[i++];
+		if (arg == "-micro") { run_micro = true; }
+		else if (arg == "-macro") { run_macro = true; }
+		else if (arg == "-fork") { run_fork = true; }
+		else if (arg == "-threads" && i < argc) { threads = (unsigned)atoi(argv[i++]); }
+		else if (arg == "-rom" && i < argc) { roms.push_back(argv[i++]); }
+		else if (arg == "-frames" && i < argc) { frames = atoi(argv[i++]); }
+		else if (arg == "-bootrom" && i < argc) { BootRom::bootromPath = argv[i++]; }
+		else if (arg == "-out" && i < argc) { out_path = argv[i++]; }
+		else if (arg == "-nofusion") { fusion = false; }
+		else if (arg == "-scanline") { PPU::fidelity = PPU::FIDELITY::SCANLINE; }
+		else if (arg == "-writerom" && i < argc) { write_rom_path = argv[i++]; }
+		else
+		{
+			fprintf(stderr, "unknown argument %s\n", arg.c_str());
+			return 1;
+		}
+	}
+	if (!write_rom_path.empty())
+	{
+		const Cartridge::Rom rom = BuildBenchRom();
+		FILE* file = fopen(write_rom_path.c_str(), "wb");
+		const bool written = file && fwrite(rom->data(), 1, rom->size(), file) == rom->size();
+		if (file)
+		{
+			fclose(file);
+		}
+		if (!written)
+		{
+			fprintf(stderr, "can't write %s\n", write_rom_path.c_str());
+			return 1;
+		}
+		printf("wrote %s\n", write_rom_path.c_str());
+		return 0;
+	}
+	if (!run_micro && !run_macro && !run_fork)
+	{
+		run_micro = run_macro = run_fork = true;
+	}
+
+	Fusion::SetEnabled(fusion);
+	BootRom::LoadFromDisk();
+	Cartridge::rom_path = default_rom_path;
+	Cartridge::LoadGameRom();
+
+	const std::string revision = GitRevision();
+	printf("gbemu_bench @ %s\n", revision.c_str());
+
+	std::vector<OpcodeResult> opcodes;
+	std::vector<RegionResult> regions;
+	double ns_per_scanline = 0.0;
+	double ns_per_frame = 0.0;
+	if (run_micro)
+	{
+		opcodes = BenchOpcodes();
+		double total = 0.0;
+		for (const OpcodeResult& result : opcodes)
+		{
+			total += result.nsPerOp;
+		}
+		printf("opcodes: %zu handlers, mean %.2f ns/op\n", opcodes.size(), total / opcodes.size());
+
+		regions = BenchBusLoads();
+		for (const RegionResult& result : regions)
+		{
+			printf("Bus::LoadU8 %-8s %.2f ns\n", result.region, result.nsPerLoad);
+		}
+
+		BenchPPU(ns_per_scanline, ns_per_frame);
+		printf("PPU: %.0f ns/scanline, %.0f ns/frame\n", ns_per_scanline, ns_per_frame);
+	}
+
+	std::vector<RomResult> rom_results;
+	if (run_macro)
+	{
+		rom_results.push_back(BenchRom(bench_rom_name, BuildBenchRom(), false, frames));
+		for (const std::string& path : roms)
+		{
+			Cartridge::Rom rom = Cartridge::LoadRom(path);
+			if (!rom)
+			{
+				fprintf(stderr, "can't load %s\n", path.c_str());
+				return 1;
+			}
+			rom_results.push_back(BenchRom(path, rom, true, frames));
+		}
+		for (const RomResult& result : rom_results)
+		{
+			printf("%s: %d frames, %.1f fps interpreted, %.1f fps fused (%.2fx)", result.rom.c_str(), result.frames, result.interpretedFps, result.fusedFps, result.fusedFps / result.interpretedFps);
+			if (result.recompiledFps > 0.0)
+			{
+				printf(", %.1f fps recompiled (%.2fx)", result.recompiledFps, result.recompiledFps / result.interpretedFps);
+			}
+			printf("\n");
+		}
+		Fusion::SetEnabled(fusion);
+	}
+
+	ForkResult fork_result;
+	if (run_fork)
+	{
+		fork_result = BenchFork(roms.back(), threads);
+		printf("fork: %d children, %.1f child fps forked vs %.1f serial, %d mismatched\n", fork_result.children, fork_result.childFps, fork_result.serialFps, fork_result.mismatches);
+	}
+
+	FILE* out = fopen(out_path.c_str(), "w");
+	if (!out)
+	{
+		fprintf(stderr, "can't write %s\n", out_path.c_str());
+		return 1;
+	}
+	fprintf(out, "{\n  \"revision\": \"%s\",\n  \"fusion\": %s,\n  \"scanline\": %s,\n", EscapeJson(revision).c_str(), fusion ? "true" : "false", PPU::fidelity == PPU::FIDELITY::SCANLINE ? "true" : "false");
+	fprintf(out, "  \"micro\": {\n    \"opcodes\": [");
+	for (std::size_t i = 0; i < opcodes.size(); ++i)
+	{
+		fprintf(out, "%s\n      { \"table\": \"%s\", \"opcode\": %d, \"ns_per_op\": %.3f }", i ? "," : "", opcodes[i].table, opcodes[i].opcode, opcodes[i].nsPerOp);
+	}
+	fprintf(out, "\n    ],\n    \"bus_load\": [");
+	for (std::size_t i = 0; i < regions.size(); ++i)
+	{
+		fprintf(out, "%s\n      { \"region\": \"%s\", \"ns_per_load\": %.3f }", i ? "," : "", regions[i].region, regions[i].nsPerLoad);
+	}
+	fprintf(out, "\n    ],\n    \"ppu\": { \"ns_per_scanline\": %.1f, \"ns_per_frame\": %.1f }\n  },\n", ns_per_scanline, ns_per_frame);
+	fprintf(out, "  \"macro\": [");
+	for (std::size_t i = 0; i < rom_results.size(); ++i)
+	{
+		const RomResult& result = rom_results[i];
+		fprintf(out, "%s\n    { \"rom\": \"%s\", \"frames\": %d, \"interpreted_fps\": %.2f, \"fused_fps\": %.2f, \"fused_speedup\": %.3f", i ? "," : "", EscapeJson(result.rom).c_str(), result.frames, result.interpretedFps, result.fusedFps, result.fusedFps / result.interpretedFps);
+		if (result.recompiledFps > 0.0)
+		{
+			fprintf(out, ", \"recompiled_fps\": %.2f, \"recompiled_speedup\": %.3f", result.recompiledFps, result.recompiledFps / result.interpretedFps);
+		}
+		fprintf(out, " }");
+	}
+	fprintf(out, "\n  ],\n");
+	fprintf(out, "  \"fork\": { \"children\": %d, \"child_fps\": %.2f, \"serial_fps\": %.2f, \"mismatches\": %d }\n}\n", fork_result.children, fork_result.childFps, fork_result.serialFps, fork_result.mismatches);
+	fclose(out);
+
+	printf("wrote %s\n", out_path.c_str());
+	return fork_result.mismatches ? 1 : 0;
+}
@@ -0,0 +1,1605 @@
+// Generated by gbemu_recompile from bench.gb, do not edit.
+
+#include "operations.h"
+#include "recompiled.h"
+
+namespace
+{
+
+std::size_t Block_00_0000()
+{
+	std::size_t c;
+
+	// 0000  00
+	reg.PC = 0x0001;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0001  00
+	reg.PC = 0x0002;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0002  00
+	reg.PC = 0x0003;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0003  00
+	reg.PC = 0x0004;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0004  00
+	reg.PC = 0x0005;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0005  00
+	reg.PC = 0x0006;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0006  00
+	reg.PC = 0x0007;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0007  00
+	reg.PC = 0x0008;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0008()
+{
+	std::size_t c;
+
+	// 0008  00
+	reg.PC = 0x0009;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0009  00
+	reg.PC = 0x000A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 000A  00
+	reg.PC = 0x000B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 000B  00
+	reg.PC = 0x000C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 000C  00
+	reg.PC = 0x000D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 000D  00
+	reg.PC = 0x000E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 000E  00
+	reg.PC = 0x000F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 000F  00
+	reg.PC = 0x0010;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0010()
+{
+	std::size_t c;
+
+	// 0010  00
+	reg.PC = 0x0011;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0011  00
+	reg.PC = 0x0012;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0012  00
+	reg.PC = 0x0013;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0013  00
+	reg.PC = 0x0014;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0014  00
+	reg.PC = 0x0015;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0015  00
+	reg.PC = 0x0016;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0016  00
+	reg.PC = 0x0017;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0017  00
+	reg.PC = 0x0018;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0018()
+{
+	std::size_t c;
+
+	// 0018  00
+	reg.PC = 0x0019;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0019  00
+	reg.PC = 0x001A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 001A  00
+	reg.PC = 0x001B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 001B  00
+	reg.PC = 0x001C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 001C  00
+	reg.PC = 0x001D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 001D  00
+	reg.PC = 0x001E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 001E  00
+	reg.PC = 0x001F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 001F  00
+	reg.PC = 0x0020;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0020()
+{
+	std::size_t c;
+
+	// 0020  00
+	reg.PC = 0x0021;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0021  00
+	reg.PC = 0x0022;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0022  00
+	reg.PC = 0x0023;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0023  00
+	reg.PC = 0x0024;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0024  00
+	reg.PC = 0x0025;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0025  00
+	reg.PC = 0x0026;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0026  00
+	reg.PC = 0x0027;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0027  00
+	reg.PC = 0x0028;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0028()
+{
+	std::size_t c;
+
+	// 0028  00
+	reg.PC = 0x0029;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0029  00
+	reg.PC = 0x002A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 002A  00
+	reg.PC = 0x002B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 002B  00
+	reg.PC = 0x002C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 002C  00
+	reg.PC = 0x002D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 002D  00
+	reg.PC = 0x002E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 002E  00
+	reg.PC = 0x002F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 002F  00
+	reg.PC = 0x0030;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0030()
+{
+	std::size_t c;
+
+	// 0030  00
+	reg.PC = 0x0031;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0031  00
+	reg.PC = 0x0032;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0032  00
+	reg.PC = 0x0033;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0033  00
+	reg.PC = 0x0034;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0034  00
+	reg.PC = 0x0035;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0035  00
+	reg.PC = 0x0036;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0036  00
+	reg.PC = 0x0037;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0037  00
+	reg.PC = 0x0038;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0038()
+{
+	std::size_t c;
+
+	// 0038  00
+	reg.PC = 0x0039;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0039  00
+	reg.PC = 0x003A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 003A  00
+	reg.PC = 0x003B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 003B  00
+	reg.PC = 0x003C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 003C  00
+	reg.PC = 0x003D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 003D  00
+	reg.PC = 0x003E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 003E  00
+	reg.PC = 0x003F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 003F  00
+	reg.PC = 0x0040;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0040()
+{
+	std::size_t c;
+
+	// 0040  00
+	reg.PC = 0x0041;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0041  00
+	reg.PC = 0x0042;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0042  00
+	reg.PC = 0x0043;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0043  00
+	reg.PC = 0x0044;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0044  00
+	reg.PC = 0x0045;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0045  00
+	reg.PC = 0x0046;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0046  00
+	reg.PC = 0x0047;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0047  00
+	reg.PC = 0x0048;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0048()
+{
+	std::size_t c;
+
+	// 0048  00
+	reg.PC = 0x0049;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0049  00
+	reg.PC = 0x004A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 004A  00
+	reg.PC = 0x004B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 004B  00
+	reg.PC = 0x004C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 004C  00
+	reg.PC = 0x004D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 004D  00
+	reg.PC = 0x004E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 004E  00
+	reg.PC = 0x004F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 004F  00
+	reg.PC = 0x0050;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0050()
+{
+	std::size_t c;
+
+	// 0050  00
+	reg.PC = 0x0051;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0051  00
+	reg.PC = 0x0052;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0052  00
+	reg.PC = 0x0053;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0053  00
+	reg.PC = 0x0054;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0054  00
+	reg.PC = 0x0055;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0055  00
+	reg.PC = 0x0056;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0056  00
+	reg.PC = 0x0057;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0057  00
+	reg.PC = 0x0058;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0058()
+{
+	std::size_t c;
+
+	// 0058  00
+	reg.PC = 0x0059;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0059  00
+	reg.PC = 0x005A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 005A  00
+	reg.PC = 0x005B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 005B  00
+	reg.PC = 0x005C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 005C  00
+	reg.PC = 0x005D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 005D  00
+	reg.PC = 0x005E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 005E  00
+	reg.PC = 0x005F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 005F  00
+	reg.PC = 0x0060;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0060()
+{
+	std::size_t c;
+
+	// 0060  00
+	reg.PC = 0x0061;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0061  00
+	reg.PC = 0x0062;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0062  00
+	reg.PC = 0x0063;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0063  00
+	reg.PC = 0x0064;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0064  00
+	reg.PC = 0x0065;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0065  00
+	reg.PC = 0x0066;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0066  00
+	reg.PC = 0x0067;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0067  00
+	reg.PC = 0x0068;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0068  00
+	reg.PC = 0x0069;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0069  00
+	reg.PC = 0x006A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 006A  00
+	reg.PC = 0x006B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 006B  00
+	reg.PC = 0x006C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 006C  00
+	reg.PC = 0x006D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 006D  00
+	reg.PC = 0x006E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 006E  00
+	reg.PC = 0x006F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 006F  00
+	reg.PC = 0x0070;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0070  00
+	reg.PC = 0x0071;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0071  00
+	reg.PC = 0x0072;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0072  00
+	reg.PC = 0x0073;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0073  00
+	reg.PC = 0x0074;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0074  00
+	reg.PC = 0x0075;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0075  00
+	reg.PC = 0x0076;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0076  00
+	reg.PC = 0x0077;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0077  00
+	reg.PC = 0x0078;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0078  00
+	reg.PC = 0x0079;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0079  00
+	reg.PC = 0x007A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 007A  00
+	reg.PC = 0x007B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 007B  00
+	reg.PC = 0x007C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 007C  00
+	reg.PC = 0x007D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 007D  00
+	reg.PC = 0x007E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 007E  00
+	reg.PC = 0x007F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 007F  00
+	reg.PC = 0x0080;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0080  00
+	reg.PC = 0x0081;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0081  00
+	reg.PC = 0x0082;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0082  00
+	reg.PC = 0x0083;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0083  00
+	reg.PC = 0x0084;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0084  00
+	reg.PC = 0x0085;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0085  00
+	reg.PC = 0x0086;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0086  00
+	reg.PC = 0x0087;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0087  00
+	reg.PC = 0x0088;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0088  00
+	reg.PC = 0x0089;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0089  00
+	reg.PC = 0x008A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 008A  00
+	reg.PC = 0x008B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 008B  00
+	reg.PC = 0x008C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 008C  00
+	reg.PC = 0x008D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 008D  00
+	reg.PC = 0x008E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 008E  00
+	reg.PC = 0x008F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 008F  00
+	reg.PC = 0x0090;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0090  00
+	reg.PC = 0x0091;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0091  00
+	reg.PC = 0x0092;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0092  00
+	reg.PC = 0x0093;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0093  00
+	reg.PC = 0x0094;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0094  00
+	reg.PC = 0x0095;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0095  00
+	reg.PC = 0x0096;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0096  00
+	reg.PC = 0x0097;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0097  00
+	reg.PC = 0x0098;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0098  00
+	reg.PC = 0x0099;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0099  00
+	reg.PC = 0x009A;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 009A  00
+	reg.PC = 0x009B;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 009B  00
+	reg.PC = 0x009C;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 009C  00
+	reg.PC = 0x009D;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 009D  00
+	reg.PC = 0x009E;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 009E  00
+	reg.PC = 0x009F;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 009F  00
+	reg.PC = 0x00A0;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A0  00
+	reg.PC = 0x00A1;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A1  00
+	reg.PC = 0x00A2;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A2  00
+	reg.PC = 0x00A3;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A3  00
+	reg.PC = 0x00A4;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A4  00
+	reg.PC = 0x00A5;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A5  00
+	reg.PC = 0x00A6;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A6  00
+	reg.PC = 0x00A7;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A7  00
+	reg.PC = 0x00A8;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A8  00
+	reg.PC = 0x00A9;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00A9  00
+	reg.PC = 0x00AA;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00AA  00
+	reg.PC = 0x00AB;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00AB  00
+	reg.PC = 0x00AC;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00AC  00
+	reg.PC = 0x00AD;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00AD  00
+	reg.PC = 0x00AE;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00AE  00
+	reg.PC = 0x00AF;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00AF  00
+	reg.PC = 0x00B0;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B0  00
+	reg.PC = 0x00B1;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B1  00
+	reg.PC = 0x00B2;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B2  00
+	reg.PC = 0x00B3;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B3  00
+	reg.PC = 0x00B4;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B4  00
+	reg.PC = 0x00B5;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B5  00
+	reg.PC = 0x00B6;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B6  00
+	reg.PC = 0x00B7;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B7  00
+	reg.PC = 0x00B8;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B8  00
+	reg.PC = 0x00B9;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00B9  00
+	reg.PC = 0x00BA;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00BA  00
+	reg.PC = 0x00BB;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00BB  00
+	reg.PC = 0x00BC;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00BC  00
+	reg.PC = 0x00BD;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00BD  00
+	reg.PC = 0x00BE;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00BE  00
+	reg.PC = 0x00BF;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00BF  00
+	reg.PC = 0x00C0;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C0  00
+	reg.PC = 0x00C1;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C1  00
+	reg.PC = 0x00C2;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C2  00
+	reg.PC = 0x00C3;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C3  00
+	reg.PC = 0x00C4;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C4  00
+	reg.PC = 0x00C5;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C5  00
+	reg.PC = 0x00C6;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C6  00
+	reg.PC = 0x00C7;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C7  00
+	reg.PC = 0x00C8;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C8  00
+	reg.PC = 0x00C9;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00C9  00
+	reg.PC = 0x00CA;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00CA  00
+	reg.PC = 0x00CB;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00CB  00
+	reg.PC = 0x00CC;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00CC  00
+	reg.PC = 0x00CD;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00CD  00
+	reg.PC = 0x00CE;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00CE  00
+	reg.PC = 0x00CF;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00CF  00
+	reg.PC = 0x00D0;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D0  00
+	reg.PC = 0x00D1;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D1  00
+	reg.PC = 0x00D2;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D2  00
+	reg.PC = 0x00D3;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D3  00
+	reg.PC = 0x00D4;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D4  00
+	reg.PC = 0x00D5;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D5  00
+	reg.PC = 0x00D6;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D6  00
+	reg.PC = 0x00D7;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D7  00
+	reg.PC = 0x00D8;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D8  00
+	reg.PC = 0x00D9;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00D9  00
+	reg.PC = 0x00DA;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00DA  00
+	reg.PC = 0x00DB;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00DB  00
+	reg.PC = 0x00DC;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00DC  00
+	reg.PC = 0x00DD;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00DD  00
+	reg.PC = 0x00DE;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00DE  00
+	reg.PC = 0x00DF;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00DF  00
+	reg.PC = 0x00E0;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E0  00
+	reg.PC = 0x00E1;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E1  00
+	reg.PC = 0x00E2;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E2  00
+	reg.PC = 0x00E3;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E3  00
+	reg.PC = 0x00E4;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E4  00
+	reg.PC = 0x00E5;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E5  00
+	reg.PC = 0x00E6;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E6  00
+	reg.PC = 0x00E7;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E7  00
+	reg.PC = 0x00E8;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E8  00
+	reg.PC = 0x00E9;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00E9  00
+	reg.PC = 0x00EA;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00EA  00
+	reg.PC = 0x00EB;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00EB  00
+	reg.PC = 0x00EC;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00EC  00
+	reg.PC = 0x00ED;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00ED  00
+	reg.PC = 0x00EE;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00EE  00
+	reg.PC = 0x00EF;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00EF  00
+	reg.PC = 0x00F0;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F0  00
+	reg.PC = 0x00F1;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F1  00
+	reg.PC = 0x00F2;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F2  00
+	reg.PC = 0x00F3;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F3  00
+	reg.PC = 0x00F4;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F4  00
+	reg.PC = 0x00F5;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F5  00
+	reg.PC = 0x00F6;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F6  00
+	reg.PC = 0x00F7;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F7  00
+	reg.PC = 0x00F8;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F8  00
+	reg.PC = 0x00F9;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00F9  00
+	reg.PC = 0x00FA;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00FA  00
+	reg.PC = 0x00FB;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00FB  00
+	reg.PC = 0x00FC;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00FC  00
+	reg.PC = 0x00FD;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00FD  00
+	reg.PC = 0x00FE;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00FE  00
+	reg.PC = 0x00FF;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 00FF  00
+	reg.PC = 0x0100;
+	c = Operation<0x00>()();
+	return c;
+}
+
+std::size_t Block_00_0100()
+{
+	std::size_t c;
+
+	// 0100  00
+	reg.PC = 0x0101;
+	c = Operation<0x00>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0101  C3 5E 01
+	reg.PC = 0x0102;
+	c = Operation<0xC3>()();
+	return c;
+}
+
+std::size_t Block_00_0150()
+{
+	std::size_t c;
+
+	// 0150  06 08
+	reg.PC = 0x0151;
+	c = Operation<0x06>()();
+	return c;
+}
+
+std::size_t Block_00_0152()
+{
+	std::size_t c;
+
+	// 0152  CB 23
+	reg.PC = 0x0154;
+	c = ExtendedOperation<0x23>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0154  CB 12
+	reg.PC = 0x0156;
+	c = ExtendedOperation<0x12>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0156  05
+	reg.PC = 0x0157;
+	c = Operation<0x05>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0157  20 F9
+	reg.PC = 0x0158;
+	c = Operation<0x20>()();
+	return c;
+}
+
+std::size_t Block_00_0159()
+{
+	std::size_t c;
+
+	// 0159  7A
+	reg.PC = 0x015A;
+	c = Operation<0x7A>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 015A  EA 02 C0
+	reg.PC = 0x015B;
+	c = Operation<0xEA>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 015D  C9
+	reg.PC = 0x015E;
+	c = Operation<0xC9>()();
+	return c;
+}
+
+std::size_t Block_00_015E()
+{
+	std::size_t c;
+
+	// 015E  F3
+	reg.PC = 0x015F;
+	c = Operation<0xF3>()();
+	return c;
+}
+
+std::size_t Block_00_015F()
+{
+	std::size_t c;
+
+	// 015F  31 FE FF
+	reg.PC = 0x0160;
+	c = Operation<0x31>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0162  3E 91
+	reg.PC = 0x0163;
+	c = Operation<0x3E>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0164  E0 40
+	reg.PC = 0x0165;
+	c = Operation<0xE0>()();
+	return c;
+}
+
+std::size_t Block_00_0166()
+{
+	std::size_t c;
+
+	// 0166  21 00 00
+	reg.PC = 0x0167;
+	c = Operation<0x21>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0169  01 00 20
+	reg.PC = 0x016A;
+	c = Operation<0x01>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 016C  11 00 00
+	reg.PC = 0x016D;
+	c = Operation<0x11>()();
+	return c;
+}
+
+std::size_t Block_00_016F()
+{
+	std::size_t c;
+
+	// 016F  2A
+	reg.PC = 0x0170;
+	c = Operation<0x2A>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0170  83
+	reg.PC = 0x0171;
+	c = Operation<0x83>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0171  5F
+	reg.PC = 0x0172;
+	c = Operation<0x5F>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0172  30 01
+	reg.PC = 0x0173;
+	c = Operation<0x30>()();
+	return c;
+}
+
+std::size_t Block_00_0174()
+{
+	std::size_t c;
+
+	// 0174  14
+	reg.PC = 0x0175;
+	c = Operation<0x14>()();
+	return c;
+}
+
+std::size_t Block_00_0175()
+{
+	std::size_t c;
+
+	// 0175  0B
+	reg.PC = 0x0176;
+	c = Operation<0x0B>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0176  78
+	reg.PC = 0x0177;
+	c = Operation<0x78>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0177  B1
+	reg.PC = 0x0178;
+	c = Operation<0xB1>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0178  20 F5
+	reg.PC = 0x0179;
+	c = Operation<0x20>()();
+	return c;
+}
+
+std::size_t Block_00_017A()
+{
+	std::size_t c;
+
+	// 017A  7B
+	reg.PC = 0x017B;
+	c = Operation<0x7B>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 017B  EA 00 C0
+	reg.PC = 0x017C;
+	c = Operation<0xEA>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 017E  7A
+	reg.PC = 0x017F;
+	c = Operation<0x7A>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 017F  EA 01 C0
+	reg.PC = 0x0180;
+	c = Operation<0xEA>()();
+	if (!Recompiled::Continue(c, 0x00)) return 0;
+
+	// 0182  CD 50 01
+	reg.PC = 0x0183;
+	c = Operation<0xCD>()();
+	return c;
+}
+
+std::size_t Block_00_0185()
+{
+	std::size_t c;
+
+	// 0185  18 DF
+	reg.PC = 0x0186;
+	c = Operation<0x18>()();
+	return c;
+}
+
+const Recompiled::Entry entries[] =
+{
+	{ 0x00, 0x0000, Block_00_0000 },
+	{ 0x00, 0x0008, Block_00_0008 },
+	{ 0x00, 0x0010, Block_00_0010 },
+	{ 0x00, 0x0018, Block_00_0018 },
+	{ 0x00, 0x0020, Block_00_0020 },
+	{ 0x00, 0x0028, Block_00_0028 },
+	{ 0x00, 0x0030, Block_00_0030 },
+	{ 0x00, 0x0038, Block_00_0038 },
+	{ 0x00, 0x0040, Block_00_0040 },
+	{ 0x00, 0x0048, Block_00_0048 },
+	{ 0x00, 0x0050, Block_00_0050 },
+	{ 0x00, 0x0058, Block_00_0058 },
+	{ 0x00, 0x0060, Block_00_0060 },
+	{ 0x00, 0x0100, Block_00_0100 },
+	{ 0x00, 0x0150, Block_00_0150 },
+	{ 0x00, 0x0152, Block_00_0152 },
+	{ 0x00, 0x0159, Block_00_0159 },
+	{ 0x00, 0x015E, Block_00_015E },
+	{ 0x00, 0x015F, Block_00_015F },
+	{ 0x00, 0x0166, Block_00_0166 },
+	{ 0x00, 0x016F, Block_00_016F },
+	{ 0x00, 0x0174, Block_00_0174 },
+	{ 0x00, 0x0175, Block_00_0175 },
+	{ 0x00, 0x017A, Block_00_017A },
+	{ 0x00, 0x0185, Block_00_0185 },
+};
+
+const bool registered = Recompiled::Register({ "GBEMU BENCH", 0x1A4B, entries, sizeof(entries) / sizeof(entries[0]) });
+
+}
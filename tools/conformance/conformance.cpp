@@ -0,0 +1,327 @@
+// Runs per-opcode JSON test vectors against operations[] and exops[] on a flat mock bus, one opcode file per
+// worker, and reports every opcode with failing cases along with a diff of the first failure.
+//
+//   gbemu_conformance <vector file or directory>... [-threads n] [-diffs n]
+//
+// Vectors use the SingleStepTests sm83 layout: a file per opcode ("8e.json", "cb 46.json") holding an array of
+//   { "name": ..., "initial": { "pc", "sp", "a", "b", "c", "d", "e", "f", "h", "l", "ime", "ie", "ram": [[address, value], ...] },
+//     "final": { same }, "cycles": [ one entry per machine cycle ] }
+// Exits non-zero unless every case passed.
+
+#include "Bus.h"
+#include "cpu.h"
+#include "interrupts.h"
+#include "json.h"
+#include "mockbus.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct OpcodeRun
+{
+	std::string path;
+	int opcode = -1;		// 0x000-0x0FF for operations[], 0x100-0x1FF for exops[]
+	std::string error;		// the file couldn't be used at all
+	std::size_t cases = 0;
+	std::size_t failures = 0;
+	std::vector<std::string> diffs;
+};
+
+// "8e.json" -> 0x08E, "cb 46.json" -> 0x146
+static int OpcodeFromPath(const std::string& path)
+{
+	std::string stem = fs::path(path).stem().string();
+	bool extended = stem.size() > 3 && (stem[0] == 'c' || stem[0] == 'C') && (stem[1] == 'b' || stem[1] == 'B') && stem[2] == ' ';
+	char* end = nullptr;
+	long opcode = strtol(stem.c_str() + (extended ? 3 : 0), &end, 16);
+	if (end == stem.c_str() + (extended ? 3 : 0) || opcode < 0 || opcode > 0xFF)
+	{
+		return -1;
+	}
+	return int(opcode) | (extended ? 0x100 : 0);
+}
+
+static bool IsUnusedOpcode(int opcode)
+{
+	static const int unused[] = { 0xD3, 0xDB, 0xDD, 0xE3, 0xE4, 0xEB, 0xEC, 0xED, 0xF4, 0xFC, 0xFD };
+	return std::find(std::begin(unused), std::end(unused), opcode) != std::end(unused);
+}
+
+static void LoadMachine(const JsonValue& state)
+{
+	CPU::State cpu = {};
+	cpu.reg.A = (u8)state.Integer("a");
+	cpu.reg.F = (u8)state.Integer("f");
+	cpu.reg.B = (u8)state.Integer("b");
+	cpu.reg.C = (u8)state.Integer("c");
+	cpu.reg.D = (u8)state.Integer("d");
+	cpu.reg.E = (u8)state.Integer("e");
+	cpu.reg.H = (u8)state.Integer("h");
+	cpu.reg.L = (u8)state.Integer("l");
+	cpu.reg.SP = (u16)state.Integer("sp");
+	cpu.reg.PC = (u16)state.Integer("pc");
+	CPU::LoadState(cpu);
+
+	Interrupts::State interrupts = {};
+	interrupts.masterEnable = state.Integer("ime") != 0;
+	interrupts.enableDelay = -1;
+	interrupts.disableDelay = -1;
+	if (state.Find("ie"))
+	{
+		interrupts.enable = (u8)state.Integer("ie");
+		MockBus::memory[0xFFFF] = interrupts.enable;
+	}
+	Interrupts::LoadState(interrupts);
+	if (const JsonValue* ram = state.Find("ram"))
+	{
+		for (const JsonValue& entry : ram->array)
+		{
+			if (entry.array.size() >= 2)
+			{
+				u16 address = (u16)entry.array[0].number;
+				MockBus::memory[address] = (u8)entry.array[1].number;
+				if (address == 0xFFFF)
+				{
+					Interrupts::W_IE(MockBus::memory[address]);
+				}
+			}
+		}
+	}
+}
+
+// Leaves the flat memory zeroed again without clearing all 64KB per case
+static void ClearMachine(const JsonValue& initial)
+{
+	for (u16 address : MockBus::writes)
+	{
+		MockBus::memory[address] = 0;
+	}
+	MockBus::writes.clear();
+	if (const JsonValue* ram = initial.Find("ram"))
+	{
+		for (const JsonValue& entry : ram->array)
+		{
+			if (!entry.array.empty())
+			{
+				MockBus::memory[(u16)entry.array[0].number] = 0;
+			}
+		}
+	}
+	MockBus::memory[0xFFFF] = 0;
+}
+
+static void CompareValue(std::string& diff, const char* name, long long expected, long long actual, int width)
+{
+	if (expected != actual)
+	{
+		char line[96];
+		snprintf(line, sizeof(line), "      %-8s expected %0*llX actual %0*llX\n", name, width, expected, width, actual);
+		diff += line;
+	}
+}
+
+// Executes the one instruction at PC and returns the diff against the expected state, empty on a pass
+static std::string RunCase(const JsonValue& test)
+{
+	const JsonValue* initial = test.Find("initial");
+	const JsonValue* expected = test.Find("final");
+	const JsonValue* cycles = test.Find("cycles");
+	if (!initial || !expected)
+	{
+		return "      malformed case\n";
+	}
+
+	LoadMachine(*initial);
+	MockBus::writes.clear();
+
+	u8 opcode = Bus::LoadU8(reg.PC++);
+	std::size_t cost = operations[opcode]();
+
+	CPU::State cpu;
+	CPU::SaveState(cpu);
+
+	std::string diff;
+	CompareValue(diff, "A", expected->Integer("a"), cpu.reg.A, 2);
+	CompareValue(diff, "F", expected->Integer("f"), cpu.reg.F, 2);
+	CompareValue(diff, "B", expected->Integer("b"), cpu.reg.B, 2);
+	CompareValue(diff, "C", expected->Integer("c"), cpu.reg.C, 2);
+	CompareValue(diff, "D", expected->Integer("d"), cpu.reg.D, 2);
+	CompareValue(diff, "E", expected->Integer("e"), cpu.reg.E, 2);
+	CompareValue(diff, "H", expected->Integer("h"), cpu.reg.H, 2);
+	CompareValue(diff, "L", expected->Integer("l"), cpu.reg.L, 2);
+	CompareValue(diff, "SP", expected->Integer("sp"), cpu.reg.SP, 4);
+	CompareValue(diff, "PC", expected->Integer("pc"), cpu.reg.PC, 4);
+	if (expected->Find("ime"))
+	{
+		// EI only takes effect after the next instruction, count the pending enable as set
+		bool ime = Interrupts::masterEnable || Interrupts::enableDelay > -1;
+		CompareValue(diff, "IME", expected->Integer("ime"), ime, 1);
+	}
+	if (expected->Find("ie"))
+	{
+		CompareValue(diff, "IE", expected->Integer("ie"), Interrupts::R_IE(), 2);
+	}
+	if (cycles)
+	{
+		CompareValue(diff, "cycles", (long long)cycles->array.size() * 4, (long long)cost, 1);
+	}
+	if (const JsonValue* ram = expected->Find("ram"))
+	{
+		for (const JsonValue& entry : ram->array)
+		{
+			if (entry.array.size() >= 2)
+			{
+				u16 address = (u16)entry.array[0].number;
+				char name[16];
+				snprintf(name, sizeof(name), "[%04X]", address);
+				CompareValue(diff, name, (long long)entry.array[1].number, Bus::LoadU8(address), 2);
+			}
+		}
+	}
+
+	ClearMachine(*initial);
+	return diff;
+}
+
+static void RunOpcode(OpcodeRun& run, std::size_t max_diffs)
+{
+	run.opcode = OpcodeFromPath(run.path);
+	if (run.opcode < 0)
+	{
+		run.error = "file name is not an opcode";
+		return;
+	}
+	if (IsUnusedOpcode(run.opcode))
+	{
+		run.error = "unused opcode, skipped";
+		return;
+	}
+
+	std::ifstream file(run.path, std::ifstream::binary);
+	if (!file)
+	{
+		run.error = "could not open";
+		return;
+	}
+	std::stringstream contents;
+	contents << file.rdbuf();
+	std::string text = contents.str();
+
+	JsonValue tests;
+	if (!ParseJson(text.data(), text.data() + text.size(), tests, run.error))
+	{
+		return;
+	}
+
+	CPU::Init();
+	MockBus::writes.clear();
+	std::fill(std::begin(MockBus::memory), std::end(MockBus::memory), 0);
+
+	for (const JsonValue& test : tests.array)
+	{
+		std::string diff = RunCase(test);
+		run.cases++;
+		if (!diff.empty())
+		{
+			run.failures++;
+			if (run.diffs.size() < max_diffs)
+			{
+				const JsonValue* name = test.Find("name");
+				run.diffs.push_back("    case \"" + (name ? name->string : std::string()) + "\"\n" + diff);
+			}
+		}
+	}
+}
+
+static void CollectVectors(const std::string& path, std::vector<std::string>& files)
+{
+	if (!fs::is_directory(path))
+	{
+		files.push_back(path);
+		return;
+	}
+
+	std::vector<std::string> found;
+	for (const auto& entry : fs::directory_iterator(path))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".json")
+		{
+			found.push_back(entry.path().string());
+		}
+	}
+	std::sort(found.begin(), found.end());
+	files.insert(files.end(), found.begin(), found.end());
+}
+
+int main(int argc, char** argv)
+{
+	unsigned threads = 0;
+	std::size_t max_diffs = 1;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc;)
+	{
+		std::string arg = argv[i++];
+		if (arg == "-threads" && i < argc) { threads = (unsigned)atoi(argv[i++]); }
+		else if (arg == "-diffs" && i < argc) { max_diffs = (std::size_t)atoi(argv[i++]); }
+		else { CollectVectors(arg, files); }
+	}
+	if (files.empty())
+	{
+		fprintf(stderr, "usage: gbemu_conformance <vector file or directory>... [-threads n] [-diffs n]\n");
+		return 1;
+	}
+
+	std::vector<OpcodeRun> runs(files.size());
+	for (std::size_t i = 0; i < files.size(); ++i)
+	{
+		runs[i].path = files[i];
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	Parallel::For(runs.size(), [&](std::size_t i) { RunOpcode(runs[i], max_diffs); }, threads);
+	double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::sort(runs.begin(), runs.end(), [](const OpcodeRun& lhs, const OpcodeRun& rhs) { return lhs.opcode < rhs.opcode; });
+
+	std::size_t cases = 0;
+	std::size_t failures = 0;
+	std::size_t failed_opcodes = 0;
+	for (const OpcodeRun& run : runs)
+	{
+		cases += run.cases;
+		failures += run.failures;
+
+		char name[8];
+		snprintf(name, sizeof(name), run.opcode >= 0x100 ? "CB %02X" : "%02X", run.opcode & 0xFF);
+		if (!run.error.empty())
+		{
+			printf("SKIP  %-6s %s: %s\n", run.opcode >= 0 ? name : "", run.path.c_str(), run.error.c_str());
+			continue;
+		}
+		if (run.failures == 0)
+		{
+			continue;
+		}
+
+		failed_opcodes++;
+		printf("FAIL  %-6s %zu/%zu cases failed\n", name, run.failures, run.cases);
+		for (const std::string& diff : run.diffs)
+		{
+			printf("%s", diff.c_str());
+		}
+	}
+
+	printf("\n%zu/%zu cases passed, %zu opcodes failing, %.2f s wall\n", cases - failures, cases, failed_opcodes, wall_seconds);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+#include "json.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+const JsonValue* JsonValue::Find(const char* key) const
+{
+	for (const auto& member : object)
+	{
+		if (member.first == key)
+		{
+			return &member.second;
+		}
+	}
+	return nullptr;
+}
+
+long long JsonValue::Integer(const char* key, long long fallback) const
+{
+	const JsonValue* member = Find(key);
+	return member && member->type == TYPE::NUMBER ? (long long)member->number : fallback;
+}
+
+class JsonParser
+{
+public:
+	JsonParser(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+	bool Parse(JsonValue& value, std::string& error)
+	{
+		if (!ParseValue(value))
+		{
+			error = message;
+			return false;
+		}
+		return true;
+	}
+
+private:
+	bool Fail(const char* what)
+	{
+		message = what;
+		return false;
+	}
+
+	void SkipWhitespace()
+	{
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r'))
+		{
+			++cursor;
+		}
+	}
+
+	bool Expect(char c)
+	{
+		SkipWhitespace();
+		if (cursor == end || *cursor != c)
+		{
+			return false;
+		}
+		++cursor;
+		return true;
+	}
+
+	bool ParseString(std::string& out)
+	{
+		if (!Expect('"'))
+		{
+			return Fail("expected a string");
+		}
+		while (cursor < end && *cursor != '"')
+		{
+			char c = *cursor++;
+			if (c == '\\' && cursor < end)
+			{
+				c = *cursor++;
+				switch (c)
+				{
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'u':
+					// Test vectors are ascii, keep the low byte
+					c = (char)strtol(std::string(cursor, std::min<std::size_t>(4, end - cursor)).c_str(), nullptr, 16);
+					cursor += std::min<std::size_t>(4, end - cursor);
+					break;
+				}
+			}
+			out += c;
+		}
+		return Expect('"') || Fail("unterminated string");
+	}
+
+	bool ParseValue(JsonValue& value)
+	{
+		SkipWhitespace();
+		if (cursor == end)
+		{
+			return Fail("unexpected end of input");
+		}
+
+		switch (*cursor)
+		{
+		case '{':
+			++cursor;
+			value.type = JsonValue::TYPE::OBJECT;
+			if (Expect('}'))
+			{
+				return true;
+			}
+			do
+			{
+				value.object.emplace_back();
+				if (!ParseString(value.object.back().first) || !Expect(':'))
+				{
+					return Fail("expected an object member");
+				}
+				if (!ParseValue(value.object.back().second))
+				{
+					return false;
+				}
+			} while (Expect(','));
+			return Expect('}') || Fail("expected '}'");
+
+		case '[':
+			++cursor;
+			value.type = JsonValue::TYPE::ARRAY;
+			if (Expect(']'))
+			{
+				return true;
+			}
+			do
+			{
+				value.array.emplace_back();
+				if (!ParseValue(value.array.back()))
+				{
+					return false;
+				}
+			} while (Expect(','));
+			return Expect(']') || Fail("expected ']'");
+
+		case '"':
+			value.type = JsonValue::TYPE::STRING;
+			return ParseString(value.string);
+
+		case 't':
+		case 'f':
+		case 'n':
+		{
+			static const char* const words[] = { "true", "false", "null" };
+			for (const char* word : words)
+			{
+				std::size_t length = strlen(word);
+				if ((std::size_t)(end - cursor) >= length && memcmp(cursor, word, length) == 0)
+				{
+					cursor += length;
+					value.type = word[0] == 'n' ? JsonValue::TYPE::NONE : JsonValue::TYPE::BOOLEAN;
+					value.number = word[0] == 't' ? 1.0 : 0.0;
+					return true;
+				}
+			}
+			return Fail("unknown literal");
+		}
+
+		default:
+		{
+			// strtod needs a terminated buffer, numbers are short
+			char buffer[64];
+			std::size_t length = 0;
+			while (cursor + length < end && length < sizeof(buffer) - 1 && strchr("+-0123456789.eE", cursor[length]))
+			{
+				++length;
+			}
+			if (!length)
+			{
+				return Fail("unexpected character");
+			}
+			memcpy(buffer, cursor, length);
+			buffer[length] = 0;
+			cursor += length;
+			value.type = JsonValue::TYPE::NUMBER;
+			value.number = strtod(buffer, nullptr);
+			return true;
+		}
+		}
+	}
+
+	const char* cursor;
+	const char* end;
+	const char* message = "";
+};
+
+bool ParseJson(const char* begin, const char* end, JsonValue& value, std::string& error)
+{
+	value = JsonValue();
+	return JsonParser(begin, end).Parse(value, error);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Just enough JSON to read test vectors: a DOM of numbers, strings, arrays and objects
+struct JsonValue
+{
+	enum class TYPE
+	{
+		NONE,
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		ARRAY,
+		OBJECT,
+	};
+
+	TYPE type = TYPE::NONE;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string, JsonValue>> object;
+
+	// Returns nullptr when this isn't an object or the key is missing
+	const JsonValue* Find(const char* key) const;
+	// Member as an integer, or fallback when missing
+	long long Integer(const char* key, long long fallback = 0) const;
+};
+
+// Returns false and sets error on malformed input
+bool ParseJson(const char* begin, const char* end, JsonValue& value, std::string& error);
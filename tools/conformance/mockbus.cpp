@@ -0,0 +1,43 @@
+// Stands in for src\Bus.cpp: a flat 64KB address space with no IO, cartridge or boot rom behind it, so a
+// single opcode runs in isolation. Every write is logged so a test case can be cleaned up cheaply. IE at 0xFFFF
+// still goes to the interrupt controller like on the real bus, so EI/HALT and interrupt dispatch see it.
+
+#include "Bus.h"
+#include "constants.h"
+#include "interrupts.h"
+#include "mockbus.h"
+
+namespace Bus
+{
+	// Declared privately by the PPU and Bus.cpp, the rest of the core still links against it
+	void StoreU8_PPU(u16 address, u8 val);
+}
+
+thread_local u8 MockBus::memory[0x10000];
+thread_local std::vector<u16> MockBus::writes;
+
+u8 Bus::LoadU8(u16 address)
+{
+	if (address == (u16)SpecialRegister::INTERRUPT_ENABLE)
+	{
+		return Interrupts::R_IE();
+	}
+	return MockBus::memory[address];
+}
+
+void Bus::StoreU8(u16 address, u8 val)
+{
+	if (address == (u16)SpecialRegister::INTERRUPT_ENABLE)
+	{
+		Interrupts::W_IE(val);
+	}
+	// Kept in memory as well, so a case's writes are cleaned up the same way
+	MockBus::memory[address] = val;
+	MockBus::writes.push_back(address);
+}
+
+void Bus::StoreU8_PPU(u16 address, u8 val)
+{
+	MockBus::memory[address] = val;
+	MockBus::writes.push_back(address);
+}
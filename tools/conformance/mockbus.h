@@ -0,0 +1,11 @@
+#pragma once
+#include "types.h"
+
+#include <vector>
+
+namespace MockBus
+{
+	extern thread_local u8 memory[0x10000];
+	// Addresses stored to since the last clear, in order
+	extern thread_local std::vector<u16> writes;
+}
@@ -0,0 +1,80 @@
+// Runs a rom headless and compares every opcode with a gameboy-doctor style reference log, printing the
+// instructions around the first divergence.
+//
+//   gbemu_doctor <rom> <reference log> [-context n] [-timeout emulated_seconds] [-bootrom path] [-ly90]
+//
+// Exits 0 when the whole log matched, 1 on a divergence and 2 when the timeout hit first. gameboy-doctor's
+// reference logs are produced with LY stubbed to 0x90; -ly90 makes LY read 0x90 while comparing to match them.
+
+#include "bootrom.h"
+#include "cartridge.h"
+#include "doctor.h"
+#include "emulator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+const double CYCLES_PER_SECOND = 4194304.0;
+
+int main(int argc, char** argv)
+{
+	std::string rom_path;
+	std::string log_path;
+	unsigned context = 8;
+	double timeout_seconds = 600.0;
+	bool stub_ly = false;
+
+	for (int i = 1; i < argc;)
+	{
+		std::string arg = argv[i++];
+		if (arg == "-context" && i < argc) { context = (unsigned)atoi(argv[i++]); }
+		else if (arg == "-timeout" && i < argc) { timeout_seconds = atof(argv[i++]); }
+		else if (arg == "-bootrom" && i < argc) { BootRom::bootromPath = argv[i++]; }
+		else if (arg == "-ly90") { stub_ly = true; }
+		else if (rom_path.empty()) { rom_path = arg; }
+		else { log_path = arg; }
+	}
+	if (rom_path.empty() || log_path.empty())
+	{
+		fprintf(stderr, "usage: gbemu_doctor <rom> <reference log> [-context n] [-timeout emulated_seconds] [-bootrom path] [-ly90]\n");
+		return 1;
+	}
+
+	BootRom::LoadFromDisk();
+	Cartridge::Rom rom = Cartridge::LoadRom(rom_path);
+	if (!rom)
+	{
+		fprintf(stderr, "could not load %s\n", rom_path.c_str());
+		return 1;
+	}
+	Cartridge::Insert(rom);
+	Emulator::Init();
+
+	if (!Doctor::Start(log_path, context, stub_ly))
+	{
+		fprintf(stderr, "could not read a reference state from %s\n", log_path.c_str());
+		return 1;
+	}
+
+	const long long max_frames = (long long)(timeout_seconds * CYCLES_PER_SECOND / Emulator::CYCLES_PER_FRAME);
+	for (long long frame = 0; frame < max_frames && Doctor::enabled; ++frame)
+	{
+		Emulator::RunFrame();
+	}
+
+	if (Doctor::Diverged())
+	{
+		printf("%s", Doctor::GetReport().c_str());
+		return 1;
+	}
+	if (Doctor::Finished())
+	{
+		printf("Matched all %llu instructions\n", (unsigned long long)Doctor::GetComparedCount());
+		return 0;
+	}
+
+	printf("Timed out after matching %llu instructions\n", (unsigned long long)Doctor::GetComparedCount());
+	Doctor::Stop();
+	return 2;
+}
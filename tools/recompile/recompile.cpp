@@ -0,0 +1,411 @@
+// Statically recompiles a rom to C++: walks the control flow from the rst and interrupt vectors (0x0000-0x0060)
+// and the entry point (0x0100), and emits one function per basic block that calls the same handler templates as
+// operations[]. Instruction lengths and control flow come from Opcodes::info. Add the output to the gbemu project to have the CPU run the blocks in place of interpreting them.
+//
+//   gbemu_recompile <rom> [-out file.cpp]
+//
+// Code in 0x4000-0x7FFF is only followed within bank 1 when reached from bank 0, since the bank is a runtime
+// property. Anything not found here (other banks, indirect jump targets, RAM) is left to the interpreter.
+
+#include "cartridge.h"
+#include "opcodes.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+const u16 BANK_SIZE = 0x4000;
+
+// A location in the rom as the cpu sees it: the bank is 0 below 0x4000
+struct Location
+{
+	u8 bank;
+	u16 address;
+
+	bool operator<(const Location& other) const
+	{
+		return bank != other.bank ? bank < other.bank : address < other.address;
+	}
+};
+
+enum class FLOW
+{
+	NEXT,			// falls through to the next instruction
+	JUMP,			// JP/JR to a known target
+	BRANCH,			// conditional JP/JR, both ways
+	CALL,			// CALL/RST, the target plus the return address
+	INDIRECT,		// RET, RETI, JP HL: target only known at runtime
+	BOUNDARY,		// HALT, STOP, EI, DI: ends the block but execution continues after it
+	INVALID,		// unused opcode, never compiled
+};
+
+struct Instruction
+{
+	Location location;
+	u8 bytes[3];
+	int length;
+	FLOW flow;
+	bool hasTarget;
+	Location target;
+};
+
+class Rom
+{
+public:
+	explicit Rom(const Cartridge::Rom& data) : data(data) {}
+
+	// -1 when the location is outside the rom
+	long Offset(const Location& location) const
+	{
+		long offset = location.address < BANK_SIZE ? location.address : location.bank * long(BANK_SIZE) + (location.address & (BANK_SIZE - 1));
+		return offset < (long)data->size() ? offset : -1;
+	}
+
+	bool Read(const Location& location, u8& value) const
+	{
+		long offset = Offset(location);
+		if (offset < 0)
+		{
+			return false;
+		}
+		value = (*data)[offset];
+		return true;
+	}
+
+	std::string Title() const
+	{
+		std::string title;
+		for (int i = 0x134; i <= 0x143 && (*data)[i]; ++i)
+		{
+			title += (char)(*data)[i];
+		}
+		return title;
+	}
+
+	u16 GlobalChecksum() const
+	{
+		return u16((*data)[0x14E] << 8 | (*data)[0x14F]);
+	}
+
+private:
+	Cartridge::Rom data;
+};
+
+// Where a jump from code at 'from' to a cpu address ends up, false for anything outside rom
+static bool TargetLocation(const Location& from, u16 address, Location& target)
+{
+	if (address >= 0x8000)
+	{
+		return false;
+	}
+	target.address = address;
+	target.bank = address < BANK_SIZE ? 0 : (from.bank ? from.bank : 1);
+	return true;
+}
+
+static bool Decode(const Rom& rom, const Location& location, Instruction& instruction)
+{
+	instruction = Instruction();
+	instruction.location = location;
+
+	u8 opcode;
+	if (!rom.Read(location, opcode))
+	{
+		return false;
+	}
+	instruction.bytes[0] = opcode;
+
+	if (opcode == 0xCB)
+	{
+		Location next = { location.bank, u16(location.address + 1) };
+		if (!rom.Read(next, instruction.bytes[1]))
+		{
+			return false;
+		}
+		instruction.length = Opcodes::extendedInfo[instruction.bytes[1]].length;
+		instruction.flow = FLOW::NEXT;
+		return true;
+	}
+
+	const Opcodes::Info& info = Opcodes::info[opcode];
+	instruction.length = info.length;
+	for (int i = 1; i < instruction.length; ++i)
+	{
+		Location next = { location.bank, u16(location.address + i) };
+		if (!rom.Read(next, instruction.bytes[i]))
+		{
+			return false;
+		}
+	}
+
+	const u16 next_address = u16(location.address + instruction.length);
+	switch (info.flow)
+	{
+	case Opcodes::FLOW::NEXT:
+		instruction.flow = FLOW::NEXT;
+		break;
+	case Opcodes::FLOW::INVALID:
+	case Opcodes::FLOW::PREFIX:
+		instruction.flow = FLOW::INVALID;
+		break;
+	case Opcodes::FLOW::HALT:
+	case Opcodes::FLOW::STOP:
+	case Opcodes::FLOW::IME:
+		instruction.flow = FLOW::BOUNDARY;
+		break;
+	case Opcodes::FLOW::RETURN:
+	case Opcodes::FLOW::JUMP_INDIRECT:
+		instruction.flow = info.conditional ? FLOW::BRANCH : FLOW::INDIRECT;
+		break;
+	case Opcodes::FLOW::JUMP:
+		instruction.flow = info.conditional ? FLOW::BRANCH : FLOW::JUMP;
+		break;
+	case Opcodes::FLOW::CALL:
+		instruction.flow = FLOW::CALL;
+		break;
+	}
+
+	switch (info.flow == Opcodes::FLOW::JUMP || info.flow == Opcodes::FLOW::CALL ? info.immediate : Opcodes::IMMEDIATE::NONE)
+	{
+	case Opcodes::IMMEDIATE::A16:
+		instruction.hasTarget = TargetLocation(location, u16(instruction.bytes[1] | instruction.bytes[2] << 8), instruction.target);
+		break;
+	case Opcodes::IMMEDIATE::R8:
+		instruction.hasTarget = TargetLocation(location, u16(next_address + (s8)instruction.bytes[1]), instruction.target);
+		break;
+	default:
+		if (info.flow == Opcodes::FLOW::CALL)
+		{
+			// RST
+			instruction.hasTarget = TargetLocation(location, u16(opcode & 0x38), instruction.target);
+		}
+		break;
+	}
+	return true;
+}
+
+static bool SameRegion(const Location& a, u16 address)
+{
+	return (a.address < BANK_SIZE) == (address < BANK_SIZE) && address < 0x8000;
+}
+
+struct Recompiler
+{
+	explicit Recompiler(const Rom& rom) : rom(rom) {}
+
+	// Finds every block leader reachable from the entry points
+	void Walk(const std::vector<Location>& entry_points)
+	{
+		std::vector<Location> work(entry_points.begin(), entry_points.end());
+		for (const Location& entry : entry_points)
+		{
+			leaders.insert(entry);
+		}
+
+		while (!work.empty())
+		{
+			Location location = work.back();
+			work.pop_back();
+
+			for (;;)
+			{
+				if (!visited.insert(location).second)
+				{
+					break;
+				}
+
+				Instruction instruction;
+				if (!Decode(rom, location, instruction) || instruction.flow == FLOW::INVALID)
+				{
+					break;
+				}
+
+				auto add_leader = [&](const Location& leader)
+				{
+					if (leaders.insert(leader).second)
+					{
+						work.push_back(leader);
+					}
+				};
+
+				if (instruction.hasTarget)
+				{
+					add_leader(instruction.target);
+				}
+
+				u16 next_address = u16(location.address + instruction.length);
+				Location next = { location.bank, next_address };
+				bool falls_through = instruction.flow == FLOW::NEXT || instruction.flow == FLOW::BRANCH
+					|| instruction.flow == FLOW::CALL || instruction.flow == FLOW::BOUNDARY;
+				if (!falls_through || !SameRegion(location, next_address))
+				{
+					break;
+				}
+				if (instruction.flow != FLOW::NEXT)
+				{
+					add_leader(next);
+					break;
+				}
+				location = next;
+			}
+		}
+	}
+
+	// A block runs from its leader up to and including the first control flow instruction, or up to the next leader
+	std::vector<Instruction> Block(const Location& leader) const
+	{
+		std::vector<Instruction> instructions;
+		Location location = leader;
+		for (;;)
+		{
+			Instruction instruction;
+			if (!Decode(rom, location, instruction) || instruction.flow == FLOW::INVALID)
+			{
+				break;
+			}
+			instructions.push_back(instruction);
+
+			u16 next_address = u16(location.address + instruction.length);
+			Location next = { location.bank, next_address };
+			if (instruction.flow != FLOW::NEXT || !SameRegion(location, next_address) || leaders.count(next))
+			{
+				break;
+			}
+			location = next;
+		}
+		return instructions;
+	}
+
+	const Rom& rom;
+	std::set<Location> leaders;
+	std::set<Location> visited;
+};
+
+static std::string BlockName(const Location& location)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "Block_%02X_%04X", location.bank, location.address);
+	return name;
+}
+
+static void EmitBlock(FILE* out, const Location& leader, const std::vector<Instruction>& instructions)
+{
+	fprintf(out, "std::size_t %s()\n{\n\tstd::size_t c;\n", BlockName(leader).c_str());
+	for (std::size_t i = 0; i < instructions.size(); ++i)
+	{
+		const Instruction& instruction = instructions[i];
+		bool extended = instruction.bytes[0] == 0xCB;
+
+		fprintf(out, "\n\t// %04X ", instruction.location.address);
+		for (int b = 0; b < instruction.length; ++b)
+		{
+			fprintf(out, " %02X", instruction.bytes[b]);
+		}
+		fprintf(out, "\n");
+
+		// Handlers fetch their operands from PC, so point it just past the opcode as the interpreter would
+		fprintf(out, "\treg.PC = 0x%04X;\n", u16(instruction.location.address + (extended ? 2 : 1)));
+		if (extended)
+		{
+			fprintf(out, "\tc = ExtendedOperation<0x%02X>()();\n", instruction.bytes[1]);
+		}
+		else
+		{
+			fprintf(out, "\tc = Operation<0x%02X>()();\n", instruction.bytes[0]);
+		}
+		if (i + 1 < instructions.size())
+		{
+			fprintf(out, "\tif (!Recompiled::Continue(c, 0x%02X)) return 0;\n", instruction.location.bank);
+		}
+	}
+	fprintf(out, "\treturn c;\n}\n\n");
+}
+
+int main(int argc, char** argv)
+{
+	std::string rom_path;
+	std::string out_path;
+
+	for (int i = 1; i < argc;)
+	{
+		std::string arg = argv[i++];
+		if (arg == "-out" && i < argc) { out_path = argv[i++]; }
+		else { rom_path = arg; }
+	}
+	if (rom_path.empty())
+	{
+		fprintf(stderr, "usage: gbemu_recompile <rom> [-out file.cpp]\n");
+		return 1;
+	}
+
+	Cartridge::Rom data = Cartridge::LoadRom(rom_path);
+	if (!data || data->size() < 0x150)
+	{
+		fprintf(stderr, "could not load %s\n", rom_path.c_str());
+		return 1;
+	}
+	Rom rom(data);
+
+	std::vector<Location> entry_points;
+	for (u16 address = 0x0000; address <= 0x0060; address += 8)
+	{
+		entry_points.push_back({ 0, address });
+	}
+	entry_points.push_back({ 0, 0x0100 });
+
+	Recompiler recompiler(rom);
+	recompiler.Walk(entry_points);
+
+	FILE* out = out_path.empty() ? stdout : fopen(out_path.c_str(), "w");
+	if (!out)
+	{
+		fprintf(stderr, "could not write %s\n", out_path.c_str());
+		return 1;
+	}
+
+	fprintf(out, "// Generated by gbemu_recompile from %s, do not edit.\n\n", rom_path.c_str());
+	fprintf(out, "#include \"operations.h\"\n#include \"recompiled.h\"\n\nnamespace\n{\n\n");
+
+	std::size_t instruction_count = 0;
+	std::vector<Location> emitted;
+	for (const Location& leader : recompiler.leaders)
+	{
+		std::vector<Instruction> instructions = recompiler.Block(leader);
+		if (instructions.empty())
+		{
+			continue;
+		}
+		EmitBlock(out, leader, instructions);
+		emitted.push_back(leader);
+		instruction_count += instructions.size();
+	}
+
+	fprintf(out, "const Recompiled::Entry entries[] =\n{\n");
+	for (const Location& leader : emitted)
+	{
+		fprintf(out, "\t{ 0x%02X, 0x%04X, %s },\n", leader.bank, leader.address, BlockName(leader).c_str());
+	}
+	fprintf(out, "};\n\n");
+
+	std::string title;
+	for (char c : rom.Title())
+	{
+		char escaped[8];
+		if (c == '"' || c == '\\') { snprintf(escaped, sizeof(escaped), "\\%c", c); }
+		else if (c < ' ' || c > '~') { snprintf(escaped, sizeof(escaped), "\\%03o", (u8)c); }
+		else { snprintf(escaped, sizeof(escaped), "%c", c); }
+		title += escaped;
+	}
+	fprintf(out, "const bool registered = Recompiled::Register({ \"%s\", 0x%04X, entries, sizeof(entries) / sizeof(entries[0]) });\n\n}\n",
+		title.c_str(), rom.GlobalChecksum());
+
+	if (out != stdout)
+	{
+		fclose(out);
+	}
+	fprintf(stderr, "%zu blocks, %zu instructions\n", emitted.size(), instruction_count);
+	return 0;
+}
@@ -0,0 +1,194 @@
+// Runs test roms headless and in parallel, judging each one by what it prints over the serial port.
+//
+//   gbemu_testroms <rom or directory>... [-timeout emulated_seconds] [-threads n] [-bootrom path]
+//
+// A rom passes once "Passed" appears in its serial output and fails on "Failed". Anything still running
+// after the timeout counts as hung. Exits non-zero unless every rom passed.
+
+#include "bootrom.h"
+#include "cartridge.h"
+#include "emulator.h"
+#include "parallel.h"
+#include "serial.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+const double CYCLES_PER_SECOND = 4194304.0;
+const int SETTLE_FRAMES = 30; // Frames without new serial output before a finished rom's output is recorded
+
+enum class RESULT
+{
+	PASSED,
+	FAILED,
+	TIMEOUT,
+	LOAD_ERROR,
+};
+
+struct RomRun
+{
+	std::string path;
+	RESULT result = RESULT::LOAD_ERROR;
+	double emulatedSeconds = 0.0;
+	double hostSeconds = 0.0;
+	std::string output;
+};
+
+static const char* ResultName(RESULT result)
+{
+	switch (result)
+	{
+	case RESULT::PASSED: return "PASS";
+	case RESULT::FAILED: return "FAIL";
+	case RESULT::TIMEOUT: return "HANG";
+	case RESULT::LOAD_ERROR: return "LOAD";
+	}
+	return "?";
+}
+
+static void RunRom(RomRun& run, double timeout_seconds)
+{
+	Cartridge::Rom rom = Cartridge::LoadRom(run.path);
+	if (!rom)
+	{
+		return;
+	}
+	Cartridge::Insert(rom);
+	Emulator::Init();
+
+	const int max_frames = int(timeout_seconds * CYCLES_PER_SECOND / Emulator::CYCLES_PER_FRAME);
+	auto start = std::chrono::steady_clock::now();
+
+	run.result = RESULT::TIMEOUT;
+	int frame = 0;
+	// Both clocks stop at the frame the verdict appeared on (or the last one for a hang), not after the settle frames
+	int verdict_frame = 0;
+	auto verdict = start;
+	int quiet_frames = 0;
+	std::size_t output_size = 0;
+	while (frame < max_frames)
+	{
+		Emulator::RunFrame();
+		frame++;
+
+		const std::string& output = Serial::GetOutput();
+		if (run.result == RESULT::TIMEOUT)
+		{
+			if (output.find("Passed") != std::string::npos)
+			{
+				run.result = RESULT::PASSED;
+			}
+			else if (output.find("Failed") != std::string::npos)
+			{
+				run.result = RESULT::FAILED;
+			}
+			verdict_frame = frame;
+			verdict = std::chrono::steady_clock::now();
+		}
+
+		// The verdict is printed a character at a time, keep going until the rom has finished saying it
+		if (output.size() != output_size)
+		{
+			output_size = output.size();
+			quiet_frames = 0;
+		}
+		else if (run.result != RESULT::TIMEOUT && ++quiet_frames == SETTLE_FRAMES)
+		{
+			break;
+		}
+	}
+
+	if (run.result == RESULT::TIMEOUT)
+	{
+		verdict_frame = frame;
+		verdict = std::chrono::steady_clock::now();
+	}
+
+	run.hostSeconds = std::chrono::duration<double>(verdict - start).count();
+	run.emulatedSeconds = double(verdict_frame) * Emulator::CYCLES_PER_FRAME / CYCLES_PER_SECOND;
+	run.output = Serial::GetOutput();
+}
+
+static void CollectRoms(const std::string& path, std::vector<std::string>& roms)
+{
+	if (!fs::is_directory(path))
+	{
+		roms.push_back(path);
+		return;
+	}
+
+	std::vector<std::string> found;
+	for (const auto& entry : fs::recursive_directory_iterator(path))
+	{
+		std::string extension = entry.path().extension().string();
+		if (entry.is_regular_file() && (extension == ".gb" || extension == ".gbc"))
+		{
+			found.push_back(entry.path().string());
+		}
+	}
+	std::sort(found.begin(), found.end());
+	roms.insert(roms.end(), found.begin(), found.end());
+}
+
+int main(int argc, char** argv)
+{
+	double timeout_seconds = 60.0;
+	unsigned threads = 0;
+	std::vector<std::string> roms;
+
+	for (int i = 1; i < argc;)
+	{
+		std::string arg = argv[i++];
+		if (arg == "-timeout" && i < argc) { timeout_seconds = atof(argv[i++]); }
+		else if (arg == "-threads" && i < argc) { threads = (unsigned)atoi(argv[i++]); }
+		else if (arg == "-bootrom" && i < argc) { BootRom::bootromPath = argv[i++]; }
+		else { CollectRoms(arg, roms); }
+	}
+	if (roms.empty())
+	{
+		fprintf(stderr, "usage: gbemu_testroms <rom or directory>... [-timeout emulated_seconds] [-threads n] [-bootrom path]\n");
+		return 1;
+	}
+
+	BootRom::LoadFromDisk();
+
+	std::vector<RomRun> runs(roms.size());
+	for (std::size_t i = 0; i < roms.size(); ++i)
+	{
+		runs[i].path = roms[i];
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	Parallel::For(runs.size(), [&](std::size_t i) { RunRom(runs[i], timeout_seconds); }, threads);
+	double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	int passed = 0;
+	double emulated_seconds = 0.0;
+	double host_seconds = 0.0;
+	for (const RomRun& run : runs)
+	{
+		double rate = run.hostSeconds > 0.0 ? run.emulatedSeconds / run.hostSeconds : 0.0;
+		printf("%s  %-48s %8.2f emu s %8.2f host s %8.2fx\n", ResultName(run.result), run.path.c_str(), run.emulatedSeconds, run.hostSeconds, rate);
+		if (run.result != RESULT::PASSED && !run.output.empty())
+		{
+			printf("      serial: %s\n", run.output.c_str());
+		}
+
+		passed += run.result == RESULT::PASSED;
+		emulated_seconds += run.emulatedSeconds;
+		host_seconds += run.hostSeconds;
+	}
+
+	printf("\n%d/%zu passed in %.2f s wall, %.2f emulated s per host s per thread, %.2f emulated s per wall s overall\n",
+		passed, runs.size(), wall_seconds,
+		host_seconds > 0.0 ? emulated_seconds / host_seconds : 0.0,
+		wall_seconds > 0.0 ? emulated_seconds / wall_seconds : 0.0);
+
+	return passed == (int)runs.size() ? 0 : 1;
+}
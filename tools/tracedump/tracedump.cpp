@@ -0,0 +1,82 @@
+// Prints a binary trace written by gbemu -trace as text, one opcode per line.
+//
+//   gbemu_tracedump <trace file> [-skip n] [-count n]
+
+#ifndef _MSC_VER
+#define _FILE_OFFSET_BITS 64 // so fseeko takes a 64 bit offset on 32 bit hosts too
+#endif
+
+#include "trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Traces get into the gigabytes, past the long offset fseek takes on Windows
+static bool Seek(FILE* file, unsigned long long offset)
+{
+#ifdef _MSC_VER
+	return _fseeki64(file, (long long)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+int main(int argc, char** argv)
+{
+	std::string path;
+	unsigned long long skip = 0;
+	unsigned long long count = ~0ULL;
+
+	for (int i = 1; i < argc;)
+	{
+		std::string arg = argv[i++];
+		if (arg == "-skip" && i < argc) { skip = strtoull(argv[i++], nullptr, 10); }
+		else if (arg == "-count" && i < argc) { count = strtoull(argv[i++], nullptr, 10); }
+		else { path = arg; }
+	}
+	if (path.empty())
+	{
+		fprintf(stderr, "usage: gbemu_tracedump <trace file> [-skip n] [-count n]\n");
+		return 1;
+	}
+
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file)
+	{
+		fprintf(stderr, "can't open %s\n", path.c_str());
+		return 1;
+	}
+
+	char magic[sizeof(Trace::FILE_MAGIC)];
+	if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, Trace::FILE_MAGIC, sizeof(magic)) != 0)
+	{
+		fprintf(stderr, "%s is not a gbemu trace\n", path.c_str());
+		fclose(file);
+		return 1;
+	}
+
+	// Records are fixed size, so skipping is a seek
+	if (!Seek(file, sizeof(magic) + skip * sizeof(Trace::Record)))
+	{
+		fprintf(stderr, "can't skip %llu records in %s\n", skip, path.c_str());
+		fclose(file);
+		return 1;
+	}
+
+	Trace::Record records[4096];
+	std::size_t read;
+	while (count && (read = fread(records, sizeof(Trace::Record), sizeof(records) / sizeof(records[0]), file)) > 0)
+	{
+		for (std::size_t i = 0; i < read && count; ++i, --count)
+		{
+			const Trace::Record& r = records[i];
+			printf("%12llu PC:%04X OP:%02X AF:%04X BC:%04X DE:%04X HL:%04X SP:%04X\n",
+				(unsigned long long)r.cycle, r.pc, r.opcode, r.af, r.bc, r.de, r.hl, r.sp);
+		}
+	}
+
+	fclose(file);
+	return 0;
+}